@@ -56,6 +56,9 @@ except ImportError:
 _settings = efel.Settings()
 _int_settings = {}
 _double_settings = {}
+# The number of the cppcore initialisation that set the current settings and
+# dependency file, 0 if cppcore doesn't hold them
+_cppcore_generation = 0
 
 
 def reset():
@@ -66,10 +69,11 @@ def reset():
     original state.
     """
 
-    global _settings, _int_settings, _double_settings
+    global _settings, _int_settings, _double_settings, _cppcore_generation
     _settings = efel.Settings()
     _int_settings = {}
     _double_settings = {}
+    _cppcore_generation = 0
 
     setDoubleSetting('spike_skipf', 0.1)
     setIntSetting('max_spike_skip', 2)
@@ -105,12 +109,13 @@ def setDependencyFileLocation(location):
                path to the location of a Dependency file
     """
 
-    global dependencyFileLocation
+    global dependencyFileLocation, _cppcore_generation
     if not os.path.exists(location):
         raise Exception(
             "Path to dependency file {%s} doesn't exist" %
             location)
     _settings.dependencyfile_path = location
+    _cppcore_generation = 0
 
 
 def getDependencyFileLocation():
@@ -237,7 +242,7 @@ def _getDistance_cpp(
 
     # Next set time, voltage and the stimulus start and end
     for item in list(trace.keys()):
-        cppcore.setFeatureDouble(item, [x for x in trace[item]])
+        cppcore.setFeatureDouble(item, trace[item])
 
     kwargs = {}
 
@@ -303,7 +308,7 @@ def getDistance(
 
     # Next set time, voltage and the stimulus start and end
     for item in list(trace.keys()):
-        cppcore.setFeatureDouble(item, [x for x in trace[item]])
+        cppcore.setFeatureDouble(item, trace[item])
 
     if trace_check:
         cppcoreFeatureValues = list()
@@ -333,27 +338,42 @@ def getDistance(
 
 def _initialise():
     """Set cppcore initial values"""
-    cppcore.Initialize(_settings.dependencyfile_path, "log")
+    global _cppcore_generation
+
+    # cppcore keeps the settings when a new trace starts, they only have to
+    # be set again if they changed or if cppcore was initialised again in the
+    # meantime (resetTrace() then returns another initialisation)
+    if _cppcore_generation > 0 and \
+            cppcore.resetTrace() == _cppcore_generation:
+        return
+
+    generation = cppcore.Initialize(_settings.dependencyfile_path, "log")
 
     # First set some settings that are used by the feature extraction
 
     for setting_name, int_setting in list(_int_settings.items()):
-        cppcore.setFeatureInt(setting_name, [int_setting])
+        cppcore.setSettingInt(setting_name, [int_setting])
 
     for setting_name, double_setting in list(_double_settings.items()):
-        cppcore.setFeatureDouble(setting_name, [double_setting])
+        cppcore.setSettingDouble(setting_name, [double_setting])
+
+    _cppcore_generation = generation
 
 
 def setIntSetting(setting_name, new_value):
     """Set a certain integer setting to a new value"""
+    global _cppcore_generation
 
     _int_settings[setting_name] = new_value
+    _cppcore_generation = 0
 
 
 def setDoubleSetting(setting_name, new_value):
     """Set a certain double setting to a new value"""
+    global _cppcore_generation
 
     _double_settings[setting_name] = new_value
+    _cppcore_generation = 0
 
 
 def getFeatureValues(
@@ -418,18 +438,196 @@ def getFeatureValues(
         return map_result
 
 
+def getFeatureValuesBatch(
+        traces,
+        featureNames,
+        n_threads=None,
+        raise_warnings=True,
+        return_errors=False):
+    """Calculate feature values for a list of traces using native threads.
+
+    This function returns the same result as getFeatureValues(), but all the
+    traces are handed over to the C++ library at once. The C++ library
+    distributes the traces over a pool of threads, without holding the Python
+    GIL, and without reinitialising the eFEL for every trace.
+    Only features implemented in C++ can be calculated this way.
+
+    Parameters
+    ==========
+    traces : list of trace dicts
+             Every trace dict represent one trace. The dict should have the
+             following keys: 'T', 'V', 'stim_start', 'stim_end'
+    feature_names : list of string
+                  List with the names of the features to be calculated on all
+                  the traces.
+    n_threads : int
+                Number of threads to use. Default is the number of cores.
+    raise_warnings: boolean
+                    Raise warning when efel c++ returns an error
+    return_errors: boolean
+                   Return the errors as well
+
+    Returns
+    =======
+    feature_values : list of dicts
+                     For every input trace a feature value dict is return (in
+                     the same order). The dict contains the keys of
+                     'feature_names', every key contains a numpy array with
+                     the feature values returned by the C++ efel code.
+                     The value is None if an error occured during the
+                     calculation of the feature.
+    errors : list of tuples
+             Only if return_errors is True, a (trace index, feature name,
+             error code, message) tuple for every feature value that is None,
+             sorted by trace. The error codes are those of eFELErrorCode in
+             cppcore/mapoperations.h, e.g. 1 if the feature could not be
+             calculated and 3 if a feature it needs is missing. Identical
+             messages are the same string object.
+    """
+
+    py_featureNames = [featureName for featureName in featureNames
+                       if featureName in pyfeatures.all_pyfeatures]
+    if py_featureNames:
+        raise Exception(
+            'getFeatureValuesBatch only supports features implemented in '
+            'C++, use getFeatureValues for: %s' % ', '.join(py_featureNames))
+
+    traces = list(traces)
+    for trace in traces:
+        _check_trace(trace)
+
+    featureNames = list(featureNames)
+    results, records, messages = cppcore.getFeatureValuesBatch(
+        _settings.dependencyfile_path,
+        traces,
+        featureNames,
+        _int_settings,
+        _double_settings,
+        0 if n_threads is None else n_threads)
+
+    for featureDict in results:
+        for featureName, values in list(featureDict.items()):
+            if values is not None:
+                dtype, feature_buffer = values
+                featureDict[featureName] = numpy.frombuffer(
+                    feature_buffer, dtype=dtype)
+
+    errors = [(trace_index, featureNames[feature_index], code,
+               messages[message_index] if message_index >= 0 else None)
+              for trace_index, feature_index, code, message_index in records]
+    if raise_warnings:
+        import warnings
+        for _, featureName, _, message in errors:
+            warnings.warn(
+                "Error while calculating feature %s: %s" %
+                (featureName, message),
+                RuntimeWarning)
+
+    if return_errors:
+        return results, errors
+    else:
+        return results
+
+
+class FeatureStream(object):
+
+    """Calculate spike features on a trace that is pushed in chunks.
+
+    For recordings that are too long to be loaded at once, or for data that
+    is still being recorded. The samples are resampled at the interp_step
+    setting like in getFeatureValues, and the values of peak_indices,
+    peak_time, peak_voltage, all_ISI_values, min_AHP_indices,
+    min_AHP_values and voltage_base are returned as soon as they are known.
+    The memory used does not grow with the length of the trace. The current
+    settings (Threshold, interp_step, ...) are used, strict_stiminterval is
+    ignored.
+
+    Parameters
+    ==========
+    stim_start : float
+                 Start of the stimulus, needed for voltage_base only.
+    """
+
+    def __init__(self, stim_start=None):
+        settings = dict(_double_settings)
+        if stim_start is not None:
+            settings['stim_start'] = stim_start
+        self._stream = cppcore.streamOpen(settings)
+
+    @staticmethod
+    def _to_arrays(values):
+        """Convert the (dtype, bytearray) tuples of cppcore to numpy arrays"""
+
+        for featureName, (dtype, feature_buffer) in list(values.items()):
+            values[featureName] = numpy.frombuffer(feature_buffer, dtype=dtype)
+        return values
+
+    def push(self, T, V):
+        """Add the time and voltage samples of the next chunk of the trace.
+
+        Returns a dict with for every feature a numpy array with the values
+        found in this chunk, Spikecount contains the number of peaks found
+        so far.
+        """
+
+        return self._to_arrays(cppcore.streamPush(self._stream, T, V))
+
+    def finish(self):
+        """End the trace, returns the last values like push()"""
+
+        return self._to_arrays(cppcore.streamFinish(self._stream))
+
+
+def generateSyntheticTrace(first_sample=0, sample_count=None, **settings):
+    """Generate a synthetic trace with known spike times.
+
+    The trace is deterministic: the same settings give the same samples, and
+    a long trace can be generated in chunks with first_sample and
+    sample_count. The settings (times in ms, voltages in mV) and their
+    defaults are duration (1000), dt (0.025), stim_start (100),
+    stim_end (900), v_rest (-65), step_amplitude (10), tau (10),
+    spike_rate in Hz (20), spike_jitter from 0 (regular) to 1 (Poisson, 0),
+    spike_amplitude (95), spike_half_width (0.5), ahp_depth (10),
+    ahp_tau (3), noise (standard deviation, 0) and seed (1).
+
+    Parameters
+    ==========
+    first_sample : int
+                   Index of the first sample to generate
+    sample_count : int
+                   Number of samples to generate, all the samples up to the
+                   end of the trace if None
+
+    Returns
+    =======
+    trace : dict
+            A trace for getFeatureValues, with the numpy arrays T and V and
+            stim_start and stim_end, and the peak times of all the spikes of
+            the trace as spike_times
+    """
+
+    if sample_count is None:
+        sample_count = -1
+    values = cppcore.generateTrace(
+        dict((name, float(value)) for name, value in settings.items()),
+        first_sample, sample_count)
+    trace = {}
+    for name in ['T', 'V', 'spike_times']:
+        dtype, buffer = values[name]
+        trace[name] = numpy.frombuffer(buffer, dtype=dtype)
+    trace['stim_start'] = [values['stim_start']]
+    trace['stim_end'] = [values['stim_end']]
+    return trace
+
+
 def get_py_feature(featureName):
     """Return python feature"""
 
     return getattr(pyfeatures, featureName)()
 
 
-def _get_feature_values_serial(trace_featurenames):
-    """Single thread of getFeatureValues"""
-
-    trace, featureNames, raise_warnings = trace_featurenames
-
-    featureDict = {}
+def _check_trace(trace):
+    """Check if the stimulus start and end in a trace dict are valid"""
 
     if 'stim_start' in trace and 'stim_end' in trace:
         try:
@@ -453,11 +651,21 @@ def _get_feature_values_serial(trace_featurenames):
     else:
         raise Exception('stim_start or stim_end missing from trace')
 
+
+def _get_feature_values_serial(trace_featurenames):
+    """Single thread of getFeatureValues"""
+
+    trace, featureNames, raise_warnings = trace_featurenames
+
+    featureDict = {}
+
+    _check_trace(trace)
+
     _initialise()
 
     # Next set time, voltage and the stimulus start and end
     for item in list(trace.keys()):
-        cppcore.setFeatureDouble(item, [x for x in trace[item]])
+        cppcore.setFeatureDouble(item, trace[item])
 
     for featureName in featureNames:
         featureDict[featureName] = _get_feature(
@@ -468,8 +676,7 @@ def _get_feature_values_serial(trace_featurenames):
 
 def get_cpp_feature(featureName, raise_warnings=None):
     """Return value of feature implemented in cpp"""
-    cppcoreFeatureValues = list()
-    exitCode = cppcore.getFeature(featureName, cppcoreFeatureValues)
+    exitCode, dtype, feature_buffer = cppcore.getFeatureArray(featureName)
 
     if exitCode < 0:
         if raise_warnings:
@@ -480,7 +687,7 @@ def get_cpp_feature(featureName, raise_warnings=None):
                 RuntimeWarning)
         return None
     else:
-        return numpy.array(cppcoreFeatureValues)
+        return numpy.frombuffer(feature_buffer, dtype=dtype)
 
 
 def getMeanFeatureValues(traces, featureNames, raise_warnings=True):
@@ -21,6 +21,10 @@
 #include <algorithm> //remove
 #include <cctype> //isspace
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#include <sys/stat.h>
 
 static void removeAllWhiteSpace(string &str) {
   str.erase(std::remove_if(str.begin(), str.end(), isspace), str.end());
@@ -46,6 +50,7 @@ cTree::cTree(const char *strFileName) {
     ErrorStr = ErrorStr + string("\nCould not open the file ") + strFileName;
   }
   getAllParents(vecFeature);
+  buildGraph();
 }
 int cTree::getDependencyList(string) {
   for (unsigned i = 0; i < strDependencyFile.size(); i++) {
@@ -62,11 +67,13 @@ int cTree::getDependencyList(string) {
  * FptrLookup | vector of pairs:
  *                  first | string: feature name
  *                  second | vector of featureStringPair
+ * Plan : execution plan, see ExecutionPlan
  *
  */
 int cTree::setFeaturePointers(map<string, feature2function *> &mapFptrLib,
                               feature2function *FptrTable,
-                              map<string, vector<featureStringPair > > *FptrLookup)
+                              map<string, vector<featureStringPair > > *FptrLookup,
+                              ExecutionPlan *Plan)
 {
   list<string>::iterator lstItr;
   map<string, feature2function *>::iterator mapLibItr;
@@ -77,6 +84,9 @@ int cTree::setFeaturePointers(map<string, feature2function *> &mapFptrLib,
   string wildcards;
 
   vector<featureStringPair> vecfptr;
+  vector<unsigned> vecstep;
+  // index of every "Lib:feature;wildcards" dependency in Plan->steps
+  std::unordered_map<string, unsigned> stepIndex;
 
   if (vecFeature.size() == 0) return -1;
 
@@ -85,10 +95,12 @@ int cTree::setFeaturePointers(map<string, feature2function *> &mapFptrLib,
   for (unsigned i = 0; i < vecFeature.size(); i++) {
 
     FinalList.clear();
+    FinalSet.clear();
     strLibFeature = vecFeature[i];
     // fill FinalList with all the dependencies of feature vecFeature[i]
-    getDependency(strLibFeature, "");
+    if (getDependency(strLibFeature, "") < 0) return -1;
     vecfptr.clear();
+    vecstep.clear();
     for (lstItr = FinalList.begin(); lstItr != FinalList.end(); lstItr++) {
       // Here strLibFeature is the feature name of the dependent feature
       strLibFeature = *lstItr;
@@ -132,10 +144,21 @@ int cTree::setFeaturePointers(map<string, feature2function *> &mapFptrLib,
       vecfptr.push_back(featureStringPair(mapFeatureItr->second, wildcards));
       FptrTable->insert(std::pair<string, feature_function>(
               strFeature, mapFeatureItr->second));
+
+      std::pair<std::unordered_map<string, unsigned>::iterator, bool> step =
+          stepIndex.insert(std::make_pair(*lstItr, Plan->steps.size()));
+      if (step.second) {
+        Plan->steps.push_back(vecfptr.back());
+        Plan->stepNames.push_back(*lstItr);
+        Plan->stepFeatures.push_back(strFeature);
+      }
+      vecstep.push_back(step.first->second);
     }
     // Add the vecfptr from above to a map with as key the base featurei
     FptrLookup->insert(
         std::pair<string, vector<featureStringPair> >(strFeature, vecfptr));
+    Plan->featureSteps.insert(
+        std::pair<string, vector<unsigned> >(strFeature, vecstep));
   }
 
   return 1;
@@ -159,64 +182,147 @@ int cTree::getAllParents(vector<string> &lstFeature) {
   return 1;
 }
 
-int cTree::getChilds(string str, list<string> &childs) {
-  string strLine, FeatureName;
+/*
+ *
+ *  Fill childMap with the dependencies of every feature in a single pass
+ *  over the dependency file. Lines are formatted as
+ *  "LibVx:feature#LibVy:dependency1#LibVz:dependency2", dependencies can
+ *  have wildcards appended as in "LibVy:dependency1;wildcards"
+ *
+ */
+void cTree::buildGraph() {
+  childMap.clear();
   for (unsigned i = 0; i < strDependencyFile.size(); i++) {
-    strLine = strDependencyFile[i];
+    const string& strLine = strDependencyFile[i];
     size_t nPos = strLine.find_first_of('#');
-    if (strLine.substr(0, nPos) != str)
-      continue;
-    else {
-      size_t nPos = strLine.find_first_of('#');
-      string Token;
-      while (nPos != string::npos) {
-        strLine = strLine.substr(nPos + 1);
-        nPos = strLine.find_first_of('#');
-        Token = strLine.substr(0, nPos);
-        childs.push_back(Token);
-      }
+    vector<string>& childs = childMap[strLine.substr(0, nPos)];
+    while (nPos != string::npos) {
+      size_t start = nPos + 1;
+      nPos = strLine.find_first_of('#', start);
+      childs.push_back(strLine.substr(
+          start, nPos == string::npos ? string::npos : nPos - start));
     }
   }
-  return 1;
 }
 
 /*
  *
  *  Fill FinalList with a list of all the feature matching the wildcards
+ *  Returns -1 and fills ErrorStr if the dependencies contain a cycle
  *
  */
 int cTree::getDependency(string strLine, string wildcards) {
-  list<string> tmpChild;
-
   // parse wildcards out of "LibVx:feature_name;wildcards_name"
   size_t wcpos = strLine.find(";");
   if (wcpos != string::npos) {
     wildcards = strLine.substr(wcpos);
     strLine = strLine.substr(0, wcpos);
   }
-  unsigned childCount = 0;
-  getChilds(strLine, tmpChild);
-  if (tmpChild.size() != 0) {
-    childCount = tmpChild.size();
-    for (unsigned i = 0; i < childCount; i++) {
-      string str = tmpChild.front();
-      tmpChild.pop_front();
-      getDependency(str, wildcards);
+  // everything below a feature that is already in the list is in it as well
+  if (FinalSet.count(strLine + wildcards)) return 0;
+
+  if (!dependencyPathSet.insert(strLine).second) {
+    ErrorStr += "\nCyclic dependency in the dependency file: ";
+    for (unsigned i = 0; i < dependencyPath.size(); i++) {
+      ErrorStr += dependencyPath[i] + " -> ";
+    }
+    ErrorStr += strLine;
+    dependencyPath.clear();
+    dependencyPathSet.clear();
+    return -1;
+  }
+  dependencyPath.push_back(strLine);
+
+  std::unordered_map<string, vector<string> >::const_iterator it(
+      childMap.find(strLine));
+  if (it != childMap.end()) {
+    for (unsigned i = 0; i < it->second.size(); i++) {
+      if (getDependency(it->second[i], wildcards) < 0) return -1;
     }
   }
-  AddUniqueItem(strLine + wildcards, FinalList);
+
+  dependencyPath.pop_back();
+  dependencyPathSet.erase(strLine);
+  FinalSet.insert(strLine + wildcards);
+  FinalList.push_back(strLine + wildcards);
   return 0;
 }
 
-int cTree::AddUniqueItem(string strFeature, list<string> &lstFinal) {
-  list<string>::iterator lstItr;
-  bool FoundFlag = false;
-  for (lstItr = lstFinal.begin(); lstItr != lstFinal.end(); lstItr++) {
-    if (strFeature == *lstItr) {
-      FoundFlag = true;
-      break;
+namespace {
+// What identifies the contents of a file without reading it. The
+// modification time has the resolution of the file system where the
+// platform exposes it (nanoseconds on Linux and macOS), seconds otherwise.
+struct FileVersion {
+  long long mtimeNs;
+  off_t size;
+  ino_t inode;
+
+  explicit FileVersion(const struct stat &fileStat)
+      : size(fileStat.st_size), inode(fileStat.st_ino) {
+#if defined(__APPLE__)
+    mtimeNs = fileStat.st_mtimespec.tv_sec * 1000000000LL +
+              fileStat.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    mtimeNs = fileStat.st_mtime * 1000000000LL;
+#else
+    mtimeNs = fileStat.st_mtim.tv_sec * 1000000000LL + fileStat.st_mtim.tv_nsec;
+#endif
+  }
+  bool operator==(const FileVersion &other) const {
+    return mtimeNs == other.mtimeNs && size == other.size &&
+           inode == other.inode;
+  }
+};
+
+struct CachedDependencyTables {
+  FileVersion version;
+  std::shared_ptr<const DependencyTables> tables;
+  // the request count at the last request of the file
+  unsigned long long lastUse;
+};
+}
+
+std::shared_ptr<const DependencyTables> getDependencyTables(
+    const string &strFileName, map<string, feature2function *> &mapFptrLib) {
+  static std::mutex cacheMutex;
+  static map<string, CachedDependencyTables> cache;
+  static unsigned long long requests = 0;
+
+  struct stat fileStat;
+  bool cacheable = stat(strFileName.c_str(), &fileStat) == 0;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  requests++;
+  if (cacheable) {
+    map<string, CachedDependencyTables>::iterator cached(
+        cache.find(strFileName));
+    if (cached != cache.end() &&
+        cached->second.version == FileVersion(fileStat)) {
+      cached->second.lastUse = requests;
+      return cached->second.tables;
     }
   }
-  if (!FoundFlag) lstFinal.push_back(strFeature);
-  return 1;
+
+  std::shared_ptr<DependencyTables> tables(new DependencyTables);
+  cTree DepTree(strFileName.c_str());
+  DepTree.setFeaturePointers(mapFptrLib, &tables->FptrTable,
+                             &tables->fptrlookup, &tables->plan);
+  tables->ErrorStr = DepTree.ErrorStr;
+
+  // a file that can't be read is not cached, it may show up later
+  if (cacheable) {
+    CachedDependencyTables entry = {FileVersion(fileStat), tables, requests};
+    cache.erase(strFileName);
+    // evict the least recently requested file
+    if (cache.size() >= maxCachedDependencyFiles) {
+      map<string, CachedDependencyTables>::iterator oldest(cache.begin());
+      for (map<string, CachedDependencyTables>::iterator it = cache.begin();
+           it != cache.end(); ++it) {
+        if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+      }
+      cache.erase(oldest);
+    }
+    cache.insert(std::make_pair(strFileName, entry));
+  }
+  return tables;
 }
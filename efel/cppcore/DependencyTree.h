@@ -23,7 +23,10 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -32,9 +35,39 @@ using std::map;
 using std::string;
 using std::vector;
 
+/*
+ * Execution plan compiled from the dependency file. Every distinct
+ * "Lib:feature;wildcards" dependency is stored once in steps, featureSteps
+ * maps a feature name to the indices of the steps it needs, in dependency
+ * order and with the feature itself last. Features that share dependencies
+ * share the step indices, so the engine can run every step only once per
+ * trace. stepNames holds the "Lib:feature;wildcards" string of every step
+ * and stepFeatures the name the step stores its values under.
+ */
+struct ExecutionPlan {
+  vector<featureStringPair> steps;
+  vector<string> stepNames;
+  vector<string> stepFeatures;
+  map<string, vector<unsigned> > featureSteps;
+  void clear() {
+    steps.clear();
+    stepNames.clear();
+    stepFeatures.clear();
+    featureSteps.clear();
+  }
+};
+
 class cTree {
   vector<string> strDependencyFile;
   vector<string> vecFeature;
+  // feature name -> names of the features it depends on, in file order
+  std::unordered_map<string, vector<string> > childMap;
+  // contents of FinalList, for constant time lookups
+  std::unordered_set<string> FinalSet;
+  // features on the current getDependency path, to detect cycles
+  vector<string> dependencyPath;
+  std::unordered_set<string> dependencyPathSet;
+  void buildGraph();
 
  public:
   string ErrorStr;
@@ -45,15 +78,39 @@ class cTree {
   int getDependencyList(string str);
   int setFeaturePointers(map<string, feature2function *> &mapFptrLib,
                          feature2function *FptrTable,
-                         map<string, vector<feature_function> > *FptrLookup);
-
-  int setFeaturePointers(map<string, feature2function *> &mapFptrLib,
-                         feature2function *FptrTable,
-                         map<string, vector<featureStringPair > > *FptrLookup);
-  int getChilds(string strLine, list<string> &childs);
+                         map<string, vector<featureStringPair > > *FptrLookup,
+                         ExecutionPlan *Plan);
   int getDependency(string strLine, string parent_stim);
-  int AddUniqueItem(string strFeature, list<string> &lstFinal);
   int getAllParents(vector<string> &vecFeature);
 };
 
+/*
+ * Everything an engine needs from a dependency file, resolved against the
+ * feature libraries. ErrorStr is not empty if the file could not be
+ * read or resolved.
+ */
+struct DependencyTables {
+  feature2function FptrTable;
+  map<string, vector<featureStringPair> > fptrlookup;
+  ExecutionPlan plan;
+  string ErrorStr;
+};
+
+// the number of dependency files whose tables getDependencyTables keeps
+const size_t maxCachedDependencyFiles = 8;
+
+/*
+ * Returns the tables of a dependency file. The file is only parsed the
+ * first time it is requested and again when its modification time, size or
+ * inode changed, otherwise the cached tables are returned. Thread safe.
+ * The modification time is compared in nanoseconds where the platform has
+ * them (seconds on Windows), but it can't be finer than the timestamps of
+ * the file system: a file rewritten with the same size within one timestamp
+ * tick of the file system (a second on some of them) is not reloaded.
+ * Only the tables of the maxCachedDependencyFiles most recently requested
+ * files are kept.
+ */
+std::shared_ptr<const DependencyTables> getDependencyTables(
+    const string &strFileName, map<string, feature2function *> &mapFptrLib);
+
 #endif
@@ -0,0 +1,205 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "FeatureBatch.h"
+#include "cfeature.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+static const int nErrorCodes = EFEL_ERROR_INVALID_TRACE + 1;
+
+// BatchErrors with the index of its messages
+class ErrorTable {
+ public:
+  ErrorTable() {
+    for (int code = 0; code < nErrorCodes; code++) {
+      errors.messages.push_back(errorCodeDescription(code));
+    }
+  }
+
+  int32_t messageIndex(const string& message) {
+    std::unordered_map<string, int32_t>::const_iterator it(
+        indices.find(message));
+    if (it != indices.end()) return it->second;
+    if (errors.messages.size() >= nErrorCodes + maxBatchMessages) return -1;
+    const int32_t index = errors.messages.size();
+    errors.messages.push_back(message);
+    indices.insert(std::make_pair(message, index));
+    return index;
+  }
+
+  BatchErrors errors;
+
+ private:
+  std::unordered_map<string, int32_t> indices;
+};
+
+static bool errorOrder(const BatchError& a, const BatchError& b) {
+  return a.trace < b.trace || (a.trace == b.trace && a.feature < b.feature);
+}
+
+static void setSettings(cFeature& feature, const BatchJob& job) {
+  for (mapStr2intVec::const_iterator it = job.intSettings.begin();
+       it != job.intSettings.end(); ++it) {
+    feature.setSettingInt(it->first, it->second);
+  }
+  for (mapStr2doubleVec::const_iterator it = job.doubleSettings.begin();
+       it != job.doubleSettings.end(); ++it) {
+    feature.setSettingDouble(it->first, it->second);
+  }
+}
+
+static void calcTrace(cFeature& feature, const BatchJob& job, size_t index,
+                      vector<BatchFeatureResult>& results,
+                      ErrorTable& errors) {
+  const mapStr2doubleVec& trace = job.traces[index];
+  // only the settings are kept from the previous trace
+  feature.resetTrace();
+  for (mapStr2doubleVec::const_iterator it = trace.begin(); it != trace.end();
+       ++it) {
+    feature.setFeatureDouble(it->first, it->second);
+  }
+
+  results.resize(job.featureNames.size());
+  for (size_t i = 0; i < job.featureNames.size(); i++) {
+    const string& name = job.featureNames[i];
+    BatchFeatureResult& result = results[i];
+
+    result.type = feature.featuretype(name);
+    if (result.type == "int") {
+      result.retval = feature.getFeatureInt(name, result.intValues);
+    } else if (result.type == "double") {
+      result.retval = feature.getFeatureDouble(name, result.doubleValues);
+    } else {
+      result.retval = -1;
+    }
+    if (result.retval < 0) {
+      BatchError record;
+      record.trace = index;
+      record.feature = i;
+      record.code =
+          GErrorCode == EFEL_ERROR_NONE ? EFEL_ERROR_FEATURE_FAILED : GErrorCode;
+      record.message = GErrorStr.empty() ? record.code
+                                         : errors.messageIndex(GErrorStr);
+      errors.errors.records.push_back(record);
+    }
+    // Don't let the errors leak into the next feature, clear() keeps the
+    // memory of the string for the next messages
+    GErrorStr.clear();
+    GErrorCode = EFEL_ERROR_NONE;
+  }
+}
+
+static void batchWorker(cFeature* feature, const BatchJob* job,
+                        std::atomic<size_t>* next,
+                        vector<vector<BatchFeatureResult> >* results,
+                        ErrorTable* errors) {
+  // The worker reports error codes, the errors of the thread from before
+  // (the calling thread is a worker) are put back afterwards
+  const bool messages = GErrorMessages;
+  const int code = GErrorCode;
+  string previousErrors;
+  previousErrors.swap(GErrorStr);
+  GErrorMessages = false;
+  GErrorCode = EFEL_ERROR_NONE;
+
+  setSettings(*feature, *job);
+  GErrorStr.clear();
+  GErrorCode = EFEL_ERROR_NONE;
+  for (size_t i = (*next)++; i < job->traces.size(); i = (*next)++) {
+    calcTrace(*feature, *job, i, (*results)[i], *errors);
+  }
+
+  GErrorMessages = messages;
+  GErrorCode = code;
+  GErrorStr.swap(previousErrors);
+}
+
+int calcFeatureBatch(const BatchJob& job, unsigned nThreads,
+                     vector<vector<BatchFeatureResult> >& results,
+                     BatchErrors& errors, string& error) {
+  results.clear();
+  results.resize(job.traces.size());
+  errors = ErrorTable().errors;
+
+  if (nThreads == 0) {
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  nThreads = std::max(
+      1u, std::min(nThreads, static_cast<unsigned>(job.traces.size())));
+
+  // Every worker gets its own engine, logging is disabled because the
+  // workers would otherwise all write to the same log file
+  const string empty_outdir;
+  vector<std::unique_ptr<cFeature> > engines;
+  for (unsigned i = 0; i < nThreads; i++) {
+    engines.push_back(
+        std::unique_ptr<cFeature>(new cFeature(job.depFile, empty_outdir)));
+  }
+
+  // calc_features exits on unknown features, check them before starting
+  for (size_t i = 0; i < job.featureNames.size(); i++) {
+    const string& name = job.featureNames[i];
+    if (engines[0]->fptrlookup.find(name) == engines[0]->fptrlookup.end()) {
+      error = engines[0]->getGError() + "\nFeature [" + name +
+              "] dependency file entry or pointer table entry is missing\n";
+      return -1;
+    }
+  }
+  engines[0]->getGError();
+
+  std::atomic<size_t> next(0);
+  vector<ErrorTable> workerErrors(nThreads);
+  vector<std::thread> threads;
+  for (unsigned i = 1; i < nThreads; i++) {
+    threads.push_back(std::thread(batchWorker, engines[i].get(), &job, &next,
+                                  &results, &workerErrors[i]));
+  }
+  // the calling thread is the first worker
+  batchWorker(engines[0].get(), &job, &next, &results, &workerErrors[0]);
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  // merge the errors of the workers into one table
+  ErrorTable table;
+  for (unsigned i = 0; i < nThreads; i++) {
+    const BatchErrors& worker = workerErrors[i].errors;
+    vector<int32_t> indices(worker.messages.size());
+    for (size_t j = 0; j < indices.size(); j++) {
+      indices[j] = j < static_cast<size_t>(nErrorCodes)
+                       ? j
+                       : table.messageIndex(worker.messages[j]);
+    }
+    for (size_t j = 0; j < worker.records.size(); j++) {
+      BatchError record = worker.records[j];
+      if (record.message >= 0) record.message = indices[record.message];
+      table.errors.records.push_back(record);
+    }
+  }
+  std::sort(table.errors.records.begin(), table.errors.records.end(),
+            errorOrder);
+  errors.records.swap(table.errors.records);
+  errors.messages.swap(table.errors.messages);
+
+  return 1;
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FEATUREBATCH_H
+#define FEATUREBATCH_H
+
+#include "types.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Value of one feature calculated on one trace
+struct BatchFeatureResult {
+  // return value of cFeature::getFeatureInt / getFeatureDouble, < 0 on error
+  int retval;
+  // "int" or "double"
+  string type;
+  vector<int> intValues;
+  vector<double> doubleValues;
+};
+
+// Failure of a feature on a trace
+struct BatchError {
+  // index in job.traces and job.featureNames
+  uint32_t trace;
+  uint32_t feature;
+  // eFELErrorCode
+  int32_t code;
+  // index in BatchErrors::messages, -1 if the table was full
+  int32_t message;
+};
+
+/*
+ * The failures of a batch, sorted by trace and feature. The messages are
+ * stored once: the first ones are the descriptions of the eFELErrorCodes
+ * (messages[code]) used when the feature functions don't explain the
+ * failure, followed by at most maxBatchMessages distinct messages of the
+ * feature functions. The map operations only report error codes in a batch,
+ * so expected misses (e.g. of optional settings) don't build messages.
+ */
+struct BatchErrors {
+  vector<BatchError> records;
+  vector<string> messages;
+};
+
+const size_t maxBatchMessages = 1024;
+
+// Everything needed to calculate a set of features on a set of traces
+struct BatchJob {
+  string depFile;
+  // settings like 'Threshold' or 'interp_step', applied to every trace
+  mapStr2intVec intSettings;
+  mapStr2doubleVec doubleSettings;
+  // trace data like 'T', 'V', 'stim_start' and 'stim_end'
+  vector<mapStr2doubleVec> traces;
+  vector<string> featureNames;
+};
+
+/*
+ * Calculate all the features of the job on all its traces, distributing the
+ * traces over nThreads worker threads that each own a cFeature engine.
+ * results[i][j] is the value of job.featureNames[j] on job.traces[i], the
+ * failed ones are in errors.
+ * Returns -1 and fills error if the job can not be run at all (e.g. unknown
+ * feature names), 1 otherwise.
+ */
+int calcFeatureBatch(const BatchJob& job, unsigned nThreads,
+                     vector<vector<BatchFeatureResult> >& results,
+                     BatchErrors& errors, string& error);
+
+#endif
@@ -0,0 +1,200 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "FeatureStream.h"
+
+#include <math.h>
+#include <utility>
+
+static double getSetting(const mapStr2doubleVec& settings, const string& name,
+                         double defaultValue, bool* found = NULL) {
+  mapStr2doubleVec::const_iterator it = settings.find(name);
+  bool present = it != settings.end() && !it->second.empty();
+  if (found) *found = present;
+  return present ? it->second[0] : defaultValue;
+}
+
+FeatureStream::FeatureStream(const mapStr2doubleVec& settings)
+    : finished(false),
+      nRaw(0),
+      firstT(0.),
+      rawT(0.),
+      rawV(0.),
+      gridT(0.),
+      index(-1),
+      previousV(0.),
+      vbDone(false),
+      vbSum(0.),
+      vbCount(0),
+      unpairedDowns(0),
+      nPeaks(0),
+      lastPeakTime(0.) {
+  threshold = getSetting(settings, "Threshold", -20.);
+  interpStep = getSetting(settings, "interp_step", 0.1);
+  const double stimStart =
+      getSetting(settings, "stim_start", 0., &haveVoltageBase);
+  vbStartTime =
+      stimStart * getSetting(settings, "voltage_base_start_perc", 0.9);
+  vbEndTime = stimStart * getSetting(settings, "voltage_base_end_perc", 1.0);
+  // as voltage_base, which fails on an empty window
+  if (vbStartTime >= vbEndTime) haveVoltageBase = false;
+}
+
+int FeatureStream::push(const double* t, const double* v, size_t n,
+                        string& error) {
+  if (finished) {
+    error = "The stream has been finished already";
+    return -1;
+  }
+  if (!(interpStep > 0)) {
+    error = "Interpolation step needs to be strictly positive";
+    return -1;
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (nRaw > 0 && !(t[i] >= rawT)) {
+      error = "The time of the samples can not decrease";
+      return -1;
+    }
+    addRawSample(t[i], v[i]);
+  }
+  return 1;
+}
+
+int FeatureStream::finish(string& error) {
+  if (finished) {
+    error = "The stream has been finished already";
+    return -1;
+  }
+  finished = true;
+
+  // LinearInterpolation adds a last point beyond the end of the trace if
+  // its size, computed as numpy.arange does, asks for it
+  if (nRaw > 1) {
+    const size_t size = ceil((rawT + interpStep - firstT) / interpStep);
+    if (static_cast<size_t>(index + 1) < size) addSample(gridT, rawV);
+  }
+
+  if (haveVoltageBase && !vbDone && vbCount > 0) {
+    pending.voltage_base.push_back(vbSum / vbCount);
+    vbDone = true;
+  }
+  // the AHP after the last peak, unless the trace is still going down at
+  // its end
+  if (nPeaks > 0 && trough.index != index) {
+    pending.min_AHP_indices.push_back(trough.index);
+    pending.min_AHP_values.push_back(trough.value);
+  }
+  return 1;
+}
+
+void FeatureStream::takeValues(StreamValues& values) {
+  values = std::move(pending);
+  pending = StreamValues();
+}
+
+// Resample as LinearInterpolation: the grid points up to t are interpolated
+// on the segment ending at t, points that fall on t exactly get v as
+// LibV1::interpolate keeps traces that are sampled at interp_step. Repeated
+// times give an empty segment, the next one starts at the last of them.
+void FeatureStream::addRawSample(double t, double v) {
+  if (nRaw++ == 0) {
+    firstT = t;
+    gridT = t;
+  } else if (t > rawT) {
+    const double dydx = (v - rawV) / (t - rawT);
+    for (; gridT <= t; gridT += interpStep) {
+      addSample(gridT, gridT == t ? v : rawV + dydx * (gridT - rawT));
+    }
+  }
+  rawT = t;
+  rawV = v;
+}
+
+void FeatureStream::addSample(double t, double v) {
+  index++;
+
+  if (haveVoltageBase && !vbDone) {
+    if (t > vbEndTime) {
+      if (vbCount > 0) pending.voltage_base.push_back(vbSum / vbCount);
+      vbDone = true;
+    } else if (t >= vbStartTime) {
+      vbSum = vbSum + v;
+      vbCount++;
+    }
+  }
+
+  if (index == 0) {
+    previousV = v;
+    return;
+  }
+  const bool up = v > threshold && previousV < threshold;
+  const bool down = v < threshold && previousV > threshold;
+  previousV = v;
+
+  if (up) {
+    if (unpairedDowns > 0) {
+      unpairedDowns--;
+    } else {
+      SpikeWindow spike;
+      spike.max = -1e9;
+      spike.maxIndex = -1;
+      spike.ahpValid = false;
+      spikes.push_back(spike);
+    }
+  }
+  for (size_t i = 0; i < spikes.size(); i++) {
+    SpikeWindow& spike = spikes[i];
+    if (spike.max < v) {
+      spike.max = v;
+      spike.maxIndex = index;
+      spike.maxTime = t;
+      spike.afterMax.start(v, index);
+      // the AHP before the peak does not include the peak itself. It is only
+      // known for the oldest spike, the others (waiting because V touched
+      // the threshold exactly) take the AHP when they are reported
+      spike.ahpValid = i == 0 && nPeaks > 0;
+      spike.ahp = trough;
+    } else {
+      spike.afterMax.add(v, index);
+    }
+  }
+  if (nPeaks > 0) trough.add(v, index);
+
+  if (down) {
+    if (spikes.empty()) {
+      unpairedDowns++;
+      return;
+    }
+    const SpikeWindow spike = spikes.front();
+    spikes.pop_front();
+    if (spike.maxIndex == -1) return;
+
+    if (nPeaks > 0) {
+      const FirstMin& ahp = spike.ahpValid ? spike.ahp : trough;
+      pending.min_AHP_indices.push_back(ahp.index);
+      pending.min_AHP_values.push_back(ahp.value);
+      pending.all_ISI_values.push_back(spike.maxTime - lastPeakTime);
+    }
+    pending.peak_indices.push_back(spike.maxIndex);
+    pending.peak_time.push_back(spike.maxTime);
+    pending.peak_voltage.push_back(spike.max);
+    nPeaks++;
+    lastPeakTime = spike.maxTime;
+    trough = spike.afterMax;
+  }
+}
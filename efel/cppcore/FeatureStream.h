@@ -0,0 +1,144 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FEATURESTREAM_H
+#define FEATURESTREAM_H
+
+#include "types.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Feature values found by a FeatureStream since they were last taken
+struct StreamValues {
+  vector<int> peak_indices;
+  vector<double> peak_time;
+  vector<double> peak_voltage;
+  vector<double> all_ISI_values;
+  vector<int> min_AHP_indices;
+  vector<double> min_AHP_values;
+  // empty until the voltage base window has passed
+  vector<double> voltage_base;
+};
+
+/*
+ * Spike features of a trace that is pushed in chunks, e.g. a long recording
+ * that does not fit in memory or the data of a live rig. The samples are
+ * resampled at interp_step as LibV1::interpolate does, and every value is
+ * reported as soon as the samples that follow can no longer change it:
+ * a peak at the down crossing of its spike, the AHP between two peaks with
+ * the second peak and the AHP after the last peak at finish(). The memory
+ * used does not depend on the length of the trace.
+ * The values are those of getFeatureValues on the whole trace, with
+ * strict_stiminterval off, except for the AHP before a spike that started
+ * while V touched the threshold exactly, and for rounding differences if the
+ * times of the trace and the resampling grid coincide only now and then.
+ * Settings (like in cFeature) are Threshold, interp_step, stim_start,
+ * voltage_base_start_perc and voltage_base_end_perc, voltage_base is only
+ * calculated if stim_start is given.
+ */
+class FeatureStream {
+ public:
+  explicit FeatureStream(const mapStr2doubleVec& settings);
+
+  // Append n samples, the times can not decrease (also with respect to the
+  // previous chunk). Returns -1 and fills error otherwise, 1 if the samples
+  // were added.
+  int push(const double* t, const double* v, size_t n, string& error);
+  // End of the trace, the samples of the last step and the AHP after the
+  // last peak are added. Nothing can be pushed afterwards.
+  int finish(string& error);
+
+  // Move the values found since the previous call into values
+  void takeValues(StreamValues& values);
+  // Number of peaks found so far
+  size_t spikeCount() const { return nPeaks; }
+
+ private:
+  // first_min_element of the samples added since start
+  struct FirstMin {
+    double value;
+    long index;
+    int counter;
+
+    void start(double v, long i) {
+      value = v;
+      index = i;
+      counter = 0;
+    }
+    void add(double v, long i) {
+      if (counter == 2) return;
+      if (v >= value) {
+        counter++;
+      } else {
+        start(v, i);
+      }
+    }
+  };
+
+  // a spike from its up crossing until its down crossing
+  struct SpikeWindow {
+    double max;
+    long maxIndex;
+    double maxTime;
+    // the AHP after the maximum
+    FirstMin afterMax;
+    // the AHP from the previous peak up to the maximum
+    bool ahpValid;
+    FirstMin ahp;
+  };
+
+  void addRawSample(double t, double v);
+  void addSample(double t, double v);
+
+  double threshold;
+  double interpStep;
+  bool haveVoltageBase;
+  double vbStartTime, vbEndTime;
+
+  // resampling
+  bool finished;
+  size_t nRaw;
+  double firstT, rawT, rawV;
+  double gridT;
+
+  // resampled trace
+  long index;
+  double previousV;
+
+  // voltage_base
+  bool vbDone;
+  double vbSum;
+  int vbCount;
+
+  // spike detection as in findThresholdPeaks
+  std::deque<SpikeWindow> spikes;
+  size_t unpairedDowns;
+  size_t nPeaks;
+  double lastPeakTime;
+  // the AHP after the last peak
+  FirstMin trough;
+
+  StreamValues pending;
+};
+
+#endif
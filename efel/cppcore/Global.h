@@ -28,10 +28,9 @@ feature2function FptrTableV2;
 feature2function FptrTableV3;
 feature2function FptrTableV4;
 feature2function FptrTableV5;
-feature2function FptrTable;
 
-std::map<std::string, feature2function*> mapFptrLib;
-
-string GErrorStr;
+// Error messages are accumulated per thread, so that several cFeature
+// instances can calculate features concurrently on different threads
+thread_local string GErrorStr;
 
 #endif
@@ -53,7 +53,8 @@ int LibV1::interpolate(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> V, T, VIntrpol, TIntrpol, InterpStepVec;
+  vector<double> VIntrpol, TIntrpol, InterpStepVec;
+  ConstVecRef<double> V, T;
   vector<int> intrpolte;
   double InterpStep;
   // getDoubleVec takes care of stimulus suffix
@@ -68,51 +69,35 @@ int LibV1::interpolate(mapStr2intVec& IntFeatureData,
   else
     InterpStep = InterpStepVec[0];
 
-  LinearInterpolation(InterpStep, T, V, TIntrpol, VIntrpol);
+  // Traces that are already sampled at interp_step, like simulator output
+  // recorded at that step, are used as they are instead of being resampled
+  // into a copy
+  if (V.size() != T.size() || !isInterpolationGrid(InterpStep, T)) {
+    LinearInterpolation(InterpStep, T, V, TIntrpol, VIntrpol);
 
-  setDoubleVec(DoubleFeatureData, StringData, "V", VIntrpol);
-  setDoubleVec(DoubleFeatureData, StringData, "T", TIntrpol);
-  setIntVec(IntFeatureData, StringData, "interpolate", intrpolte);
+    setDoubleVec(DoubleFeatureData, StringData, "V", std::move(VIntrpol));
+    setDoubleVec(DoubleFeatureData, StringData, "T", std::move(TIntrpol));
+  }
+  setIntVec(IntFeatureData, StringData, "interpolate", std::move(intrpolte));
   return retVal;
 }
 
-static int __peak_indices(double dThreshold, vector<double>& V,
+static int __peak_indices(double dThreshold, const vector<double>& V,
                           vector<int>& PeakIndex) {
-  vector<int> upVec, dnVec;
-  double dtmp;
-  int itmp;
-
-  for (unsigned i = 1; i < V.size(); i++) {
-    if (V[i] > dThreshold && V[i - 1] < dThreshold) {
-      upVec.push_back(i);
-    } else if (V[i] < dThreshold && V[i - 1] > dThreshold) {
-      dnVec.push_back(i);
-    }
-  }
-  if (dnVec.size() == 0) {
+  size_t upCrossings, downCrossings;
+  findThresholdPeaks(V, dThreshold, PeakIndex, upCrossings, downCrossings);
+  if (downCrossings == 0) {
     GErrorStr +=
         "\nVoltage never goes below or above threshold in spike detection.\n";
+    PeakIndex.clear();
     return 0;
   }
 
-  if (dnVec.size() != upVec.size()) {
+  if (downCrossings != upCrossings) {
     GErrorStr += "\nVoltage never goes below threshold after last spike.\n";
+    PeakIndex.clear();
     return 0;
   }
-
-  PeakIndex.clear();
-  int j = 0;
-  for (unsigned i = 0; i < upVec.size(); i++) {
-    dtmp = -1e9;
-    itmp = -1;
-    for (j = upVec[i]; j <= dnVec[i]; j++) {
-      if (dtmp < V[j]) {
-        dtmp = V[j];
-        itmp = j;
-      }
-    }
-    if (itmp != -1) PeakIndex.push_back(itmp);
-  }
   return PeakIndex.size();
 }
 int LibV1::peak_indices(mapStr2intVec& IntFeatureData,
@@ -125,14 +110,15 @@ int LibV1::peak_indices(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
   vector<int> PeakIndex;
-  vector<double> v, Th;
+  vector<double> Th;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal <= 0) return -1;
   retVal = getDoubleParam(DoubleFeatureData, "Threshold", Th);
   if (retVal <= 0) return -1;
   int retval = __peak_indices(Th[0], v, PeakIndex);
   if (retval >= 0)
-    setIntVec(IntFeatureData, StringData, "peak_indices", PeakIndex);
+    setIntVec(IntFeatureData, StringData, "peak_indices", std::move(PeakIndex));
   return retval;
 }
 
@@ -224,7 +210,7 @@ int LibV1::ISI_CV(mapStr2intVec& IntFeatureData,
   vector<double> isicv;
   retval = __ISI_CV(isivalues, isicv);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "ISI_CV", isicv);
+    setDoubleVec(DoubleFeatureData, StringData, "ISI_CV", std::move(isicv));
   }
   return retval;
 }
@@ -243,7 +229,8 @@ int LibV1::peak_voltage(mapStr2intVec& IntFeatureData,
   // vector<int> PeakI = getIntVec(IntFeatureData, StringData,
   // string("peak_indices"));
   vector<int> PeakI;
-  vector<double> V, peakV;
+  vector<double> peakV;
+  ConstVecRef<double> V;
 
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices", PeakI);
   if (retVal <= 0) return -1;
@@ -303,7 +290,8 @@ int LibV1::peak_time(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> PeakI;
-  vector<double> T, pvTime;
+  vector<double> pvTime;
+  ConstVecRef<double> T;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices", PeakI);
   if (retVal < 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", T);
@@ -354,10 +342,10 @@ int LibV1::min_AHP_indices(mapStr2intVec& IntFeatureData,
 
   vector<int> peak_indices_plus;
   vector<int> min_ahp_indices;
-  vector<double> v;
+  ConstVecRef<double> v;
   vector<double> min_ahp_values;
   vector<double> stim_end;
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal <= 0) return -1;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices",
@@ -372,9 +360,7 @@ int LibV1::min_AHP_indices(mapStr2intVec& IntFeatureData,
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal <= 0) return -1;
 
-  int end_index = distance(
-      t.begin(), find_if(t.begin(), t.end(),
-                         bind2nd(greater_equal<double>(), stim_end[0])));
+  int end_index = findTimeIndex(t, stim_end[0]);
   // if the last spike happens to be close to the end of the stimulus
   // there will not be a proper AHP, this case is not properly dealt with here
   if (end_index > peak_indices_plus.back() + 5) {
@@ -388,7 +374,8 @@ int LibV1::min_AHP_indices(mapStr2intVec& IntFeatureData,
     min_ahp_values.push_back(v[ahpindex]);
   }
   setIntVec(IntFeatureData, StringData, "min_AHP_indices", min_ahp_indices);
-  setDoubleVec(DoubleFeatureData, StringData, "min_AHP_values", min_ahp_values);
+  setDoubleVec(DoubleFeatureData, StringData, "min_AHP_values",
+               std::move(min_ahp_values));
   return min_ahp_indices.size();
 }
 
@@ -431,7 +418,7 @@ int LibV1::AP_amplitude(mapStr2intVec& IntFeatureData,
   vector<double> peakvoltage;
   vector<double> peaktime;
   vector<int> apbeginindices;
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal <= 0) {
     GErrorStr += "AP_amplitude: Can't find voltage vector V";
@@ -558,10 +545,10 @@ int LibV1::AHP_depth_abs_slow(mapStr2intVec& IntFeatureData,
     return nsize;
   }
 
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
   vector<int> peakindices;
@@ -609,7 +596,8 @@ int LibV1::rest_voltage_value(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v, t, stimStart, vRest;
+  vector<double> stimStart, vRest;
+  ConstVecRef<double> v, t;
   double startTime, endTime;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
@@ -624,16 +612,16 @@ int LibV1::rest_voltage_value(mapStr2intVec& IntFeatureData,
   endTime = stimStart[0] * .75;
   int nCount = 0;
   double vSum = 0;
-  // calculte the mean of voltage between startTime and endTime
-  for (unsigned i = 0; i < t.size(); i++) {
-    if (t[i] >= startTime) {
-      vSum = vSum + v[i];
-      nCount++;
-    }
-    if (t[i] > endTime) break;
+  // calculte the mean of voltage between startTime and endTime, the first
+  // point after endTime included
+  const size_t endIndex =
+      std::min(findTimeIndexAfter(t, endTime) + 1, t.size());
+  for (size_t i = findTimeIndex(t, startTime); i < endIndex; i++) {
+    vSum = vSum + v[i];
+    nCount++;
   }
   vRest.push_back(vSum / nCount);
-  setDoubleVec(DoubleFeatureData, StringData, "voltage_base", vRest);
+  setDoubleVec(DoubleFeatureData, StringData, "voltage_base", std::move(vRest));
   return 1;
 }
 
@@ -693,7 +681,8 @@ int LibV1::burst_ISI_indices(mapStr2intVec& IntFeatureData,
 
   retVal = __burst_ISI_indices(BurstFactor, PeakIndex, ISIValues, BurstIndex);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "burst_ISI_indices", BurstIndex);
+    setIntVec(IntFeatureData, StringData, "burst_ISI_indices",
+              std::move(BurstIndex));
   }
   return retVal;
 }
@@ -769,7 +758,8 @@ int LibV1::burst_number(mapStr2intVec& IntFeatureData,
 }
 
 static int __interburst_voltage(vector<int>& BurstIndex, vector<int>& PeakIndex,
-                                vector<double>& T, vector<double>& V,
+                                const vector<double>& T,
+                                const vector<double>& V,
                                 vector<double>& IBV) {
   if (BurstIndex.size() < 2) return 0;
   int j, pIndex, tsIndex, teIndex, cnt;
@@ -809,7 +799,8 @@ int LibV1::interburst_voltage(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> BurstIndex, PeakIndex;
-  vector<double> V, T, IBV;
+  vector<double> IBV;
+  ConstVecRef<double> V, T;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices", PeakIndex);
   if (retVal < 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", T);
@@ -822,7 +813,8 @@ int LibV1::interburst_voltage(mapStr2intVec& IntFeatureData,
 
   retVal = __interburst_voltage(BurstIndex, PeakIndex, T, V, IBV);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "interburst_voltage", IBV);
+    setDoubleVec(DoubleFeatureData, StringData, "interburst_voltage",
+                 std::move(IBV));
   }
   return retVal;
 }
@@ -1057,7 +1049,7 @@ int LibV1::trace_check(mapStr2intVec& IntFeatureData,
 // To find spike width using Central difference derivative vec1[i] =
 // ((vec[i+1]+vec[i-1])/2)/dx  and half width is between
 // MinAHP and APThreshold
-static int __spike_width2(vector<double>& t, vector<double>& V,
+static int __spike_width2(const vector<double>& t, const vector<double>& V,
                           vector<int>& PeakIndex, vector<int>& minAHPIndex,
                           vector<double>& spike_width2) {
   vector<double> v, dv1, dv2;
@@ -1147,7 +1139,8 @@ int LibV1::spike_width2(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> PeakIndex, minAHPIndex;
-  vector<double> V, t, dv1, dv2, spike_width2;
+  vector<double> dv1, dv2, spike_width2;
+  ConstVecRef<double> V, t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
@@ -1165,7 +1158,8 @@ int LibV1::spike_width2(mapStr2intVec& IntFeatureData,
   // Using Central difference derivative vec1[i] = ((vec[i+1]+vec[i-1])/2)/dx
   retVal = __spike_width2(t, V, PeakIndex, minAHPIndex, spike_width2);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "spike_width2", spike_width2);
+    setDoubleVec(DoubleFeatureData, StringData, "spike_width2",
+                 std::move(spike_width2));
   }
   return retVal;
 }
@@ -1176,9 +1170,7 @@ static int __spike_width1(const vector<double>& t, const vector<double>& v,
                           const vector<int>& peak_indices,
                           const vector<int>& min_ahp_indices, double stim_start,
                           vector<double>& spike_width1) {
-  int start_index = distance(
-      t.begin(), find_if(t.begin(), t.end(),
-                         bind2nd(greater_equal<double>(), stim_start)));
+  int start_index = findTimeIndex(t, stim_start);
   vector<int> min_ahp_indices_plus(min_ahp_indices.size() + 1, start_index);
   copy(min_ahp_indices.begin(), min_ahp_indices.end(),
        min_ahp_indices_plus.begin() + 1);
@@ -1223,7 +1215,8 @@ int LibV1::spike_width1(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> PeakIndex, minAHPIndex;
-  vector<double> V, t, dv1, dv2, spike_width1;
+  vector<double> dv1, dv2, spike_width1;
+  ConstVecRef<double> V, t;
   vector<double> stim_start;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
@@ -1268,17 +1261,12 @@ static int __time_constant(const vector<double>& v, const vector<double>& t,
   size_t min_length = 10;
   // minimal required time length in ms
   int t_length = 70;
-  size_t stimstartindex;
-  for (stimstartindex = 0; t[stimstartindex] < stimStart; stimstartindex++)
-    ;
-  stimstartindex += 10;
+  size_t stimstartindex = findTimeIndex(t, stimStart) + 10;
   // int stimendindex;
   // for(stimendindex = 0; t[stimendindex] < stimEnd; stimendindex++) ;
   // int stimmiddleindex = (stimstartindex + stimendindex) / 2;
-  int stimmiddleindex = distance(
-      t.begin(),
-      find_if(t.begin() + stimstartindex, t.end(),
-              bind2nd(greater_equal<double>(), (stimStart + stimEnd) / 2.)));
+  int stimmiddleindex =
+      findTimeIndex(t, (stimStart + stimEnd) / 2., stimstartindex);
   if (stimstartindex >= v.size() || stimmiddleindex < 0 ||
       static_cast<size_t>(stimmiddleindex) >= v.size()) {
     return -1;
@@ -1333,17 +1321,21 @@ static int __time_constant(const vector<double>& v, const vector<double>& t,
   //    return -1;
   //}
   // containing the flat:
-  vector<double> dvdt_decay(dvdt.begin() + i_start, dvdt.begin() + i_flat);
-  vector<double> t_decay(part_t.begin() + i_start, part_t.begin() + i_flat);
-  vector<double> v_decay(part_v.begin() + i_start, part_v.begin() + i_flat);
-  if (dvdt_decay.size() < min_length) {
+  if (static_cast<size_t>(i_flat - i_start) < min_length) {
     GErrorStr += "\nTrace fall time too short.\n";
     return -1;
   }
+  const size_t decay_length = i_flat - i_start;
+  const double* t_decay = &part_t[i_start];
+  const double* v_decay = &part_v[i_start];
 
   // fit to exponential
-  //
-  vector<double> log_v(dvdt_decay.size(), 0.);
+  // v_decay - v_decay.back() + x decays to x
+  vector<double> v_shifted(decay_length);
+  for (size_t i = 0; i < decay_length; i++) {
+    v_shifted[i] = v_decay[i] - v_decay[decay_length - 1];
+  }
+  LogLinearFit decay_fit(t_decay, &v_shifted[0], decay_length);
 
   // golden section search algorithm
   const double PHI = 1.618033988;
@@ -1352,12 +1344,8 @@ static int __time_constant(const vector<double>& v, const vector<double>& t,
   x[2] = min_derivative * 200.;
   x[1] = (x[0] * PHI + x[2]) / (1. + PHI);
   // calculate residuals at x[1]
-  for (unsigned i = 0; i < log_v.size(); i++) {
-    log_v[i] = log(v_decay[i] - v_decay.back() + x[1]);
-  }
-
   linear_fit_result fit;
-  fit = slope_straight_line_fit(t_decay, log_v);
+  fit = decay_fit.fit(x[1]);
   double residuum = fit.average_rss;
   bool right = true;
   double newx;
@@ -1369,10 +1357,7 @@ static int __time_constant(const vector<double>& v, const vector<double>& t,
       newx = (x[0] + PHI * x[1]) / (1. + PHI);
     }
     // calculate residuals at newx
-    for (unsigned i = 0; i < log_v.size(); i++) {
-      log_v[i] = log(v_decay[i] - v_decay.back() + newx);
-    }
-    fit = slope_straight_line_fit(t_decay, log_v);
+    fit = decay_fit.fit(newx);
 
     if (fit.average_rss < residuum) {
       if (right) {
@@ -1405,8 +1390,8 @@ int LibV1::time_constant(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v;
-  vector<double> t;
+  ConstVecRef<double> v;
+  ConstVecRef<double> t;
   vector<double> stimStart;
   vector<double> stimEnd;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
@@ -1420,7 +1405,7 @@ int LibV1::time_constant(mapStr2intVec& IntFeatureData,
   vector<double> tc;
   retVal = __time_constant(v, t, stimStart[0], stimEnd[0], tc);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "time_constant", tc);
+    setDoubleVec(DoubleFeatureData, StringData, "time_constant", std::move(tc));
   }
   return retVal;
 }
@@ -1432,18 +1417,16 @@ static int __voltage_deflection(const vector<double>& v,
                                 double stimEnd, vector<double>& vd) {
   const unsigned int window_size = 5;
 
-  size_t stimendindex = 0;
+  // first point after stimEnd, 0 if there is none
+  size_t stimendindex = findTimeIndexAfter(t, stimEnd);
+  const size_t base_end =
+      std::min(findTimeIndex(t, stimStart), stimendindex + 1);
+  if (stimendindex == t.size()) stimendindex = 0;
   double base = 0.;
   int base_size = 0;
-  for (size_t i = 0; i < t.size(); i++) {
-    if (t[i] < stimStart) {
-      base += v[i];
-      base_size++;
-    }
-    if (t[i] > stimEnd) {
-      stimendindex = (int)i;
-      break;
-    }
+  for (size_t i = 0; i < base_end; i++) {
+    base += v[i];
+    base_size++;
   }
   if (base_size == 0) return -1;
   base /= base_size;
@@ -1471,8 +1454,8 @@ int LibV1::voltage_deflection(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v;
-  vector<double> t;
+  ConstVecRef<double> v;
+  ConstVecRef<double> t;
   vector<double> stimStart;
   vector<double> stimEnd;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
@@ -1486,7 +1469,8 @@ int LibV1::voltage_deflection(mapStr2intVec& IntFeatureData,
   vector<double> vd;
   retVal = __voltage_deflection(v, t, stimStart[0], stimEnd[0], vd);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "voltage_deflection", vd);
+    setDoubleVec(DoubleFeatureData, StringData, "voltage_deflection",
+                 std::move(vd));
   }
   return retVal;
 }
@@ -1522,7 +1506,8 @@ int LibV1::ohmic_input_resistance(mapStr2intVec& IntFeatureData,
   retVal = __ohmic_input_resistance(voltage_deflection[0],
                                     stimulus_current[0], oir);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "ohmic_input_resistance", oir);
+    setDoubleVec(DoubleFeatureData, StringData, "ohmic_input_resistance",
+                 std::move(oir));
   }
   return retVal;
 }
@@ -1577,8 +1562,8 @@ int LibV1::maximum_voltage(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v;
-  vector<double> t;
+  ConstVecRef<double> v;
+  ConstVecRef<double> t;
   vector<double> stimStart;
   vector<double> stimEnd;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
@@ -1593,7 +1578,8 @@ int LibV1::maximum_voltage(mapStr2intVec& IntFeatureData,
   vector<double> maxV, minV;
   retVal = __maxmin_voltage(v, t, stimStart[0], stimEnd[0], maxV, minV);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "maximum_voltage", maxV);
+    setDoubleVec(DoubleFeatureData, StringData, "maximum_voltage",
+                 std::move(maxV));
   }
   return retVal;
 }
@@ -1610,8 +1596,8 @@ int LibV1::minimum_voltage(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v;
-  vector<double> t;
+  ConstVecRef<double> v;
+  ConstVecRef<double> t;
   vector<double> stimStart;
   vector<double> stimEnd;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
@@ -1625,7 +1611,8 @@ int LibV1::minimum_voltage(mapStr2intVec& IntFeatureData,
   vector<double> maxV, minV;
   retVal = __maxmin_voltage(v, t, stimStart[0], stimEnd[0], maxV, minV);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "minimum_voltage", minV);
+    setDoubleVec(DoubleFeatureData, StringData, "minimum_voltage",
+                 std::move(minV));
   }
   return retVal;
 }
@@ -1655,10 +1642,10 @@ int LibV1::steady_state_voltage(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 1) return -1;
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 1) return -1;
   vector<double> stimEnd;
@@ -1668,7 +1655,8 @@ int LibV1::steady_state_voltage(mapStr2intVec& IntFeatureData,
   vector<double> ssv;
   retVal = __steady_state_voltage(v, t, stimEnd[0], ssv);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "steady_state_voltage", ssv);
+    setDoubleVec(DoubleFeatureData, StringData, "steady_state_voltage",
+                 std::move(ssv));
   }
   return retVal;
 }
@@ -1785,9 +1773,7 @@ static int __AP_width(const vector<double>& t, const vector<double>& v,
   //   printVectorI("minahpindices", minahpindices);
   //   printf("\nStimStart = %f , thereshold = %f ", stimstart, threshold);
   vector<int> indices(minahpindices.size() + 1);
-  int start_index = distance(
-      t.begin(),
-      find_if(t.begin(), t.end(), bind2nd(greater_equal<double>(), stimstart)));
+  int start_index = findTimeIndex(t, stimstart);
   indices[0] = start_index;
   copy(minahpindices.begin(), minahpindices.end(), indices.begin() + 1);
   for (unsigned i = 0; i < indices.size() - 1; i++) {
@@ -1826,10 +1812,10 @@ int LibV1::AP_width(mapStr2intVec& IntFeatureData,
     return nsize;
   }
 
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
   vector<double> threshold;
@@ -1852,7 +1838,7 @@ int LibV1::AP_width(mapStr2intVec& IntFeatureData,
   retval = __AP_width(t, v, stimstart[0], threshold[0], peakindices,
                       minahpindices, apwidth);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_width", apwidth);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_width", std::move(apwidth));
   }
   return retval;
 }
@@ -1915,7 +1901,8 @@ int LibV1::AHP_depth(mapStr2intVec& IntFeatureData,
   vector<double> ahpdepth;
   retval = __AHP_depth(voltagebase, minahpvalues, ahpdepth);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AHP_depth", ahpdepth);
+    setDoubleVec(DoubleFeatureData, StringData, "AHP_depth",
+                 std::move(ahpdepth));
   }
   return retval;
 }
@@ -1987,7 +1974,8 @@ int LibV1::AHP_depth_diff(mapStr2intVec& IntFeatureData,
   vector<double> ahpdepthdiff;
   retval = __AHP_depth_diff(ahpdepth, ahpdepthdiff);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AHP_depth_diff", ahpdepthdiff);
+    setDoubleVec(DoubleFeatureData, StringData, "AHP_depth_diff",
+                 std::move(ahpdepthdiff));
   }
   return retval;
 }
@@ -35,25 +35,17 @@ using std::transform;
 //
 // *** AP begin indices ***
 //
-static int __AP_begin_indices(const vector<double>& t, const vector<double>& v,
-                              double stimstart, double stimend,
-                              const vector<int>& ahpi, vector<int>& apbi) {
+static int __AP_begin_indices(const vector<double>& t,
+                              const vector<double>& dvdt, double stimstart,
+                              double stimend, const vector<int>& ahpi,
+                              vector<int>& apbi) {
   // derivative at peak start according to eCode specification 10mV/ms
   // according to Shaul 12mV/ms
   const double derivativethreshold = 12.;
-  // constant time steps due to 'interpolate'
-  vector<double> dvdt(v.size());
-  vector<double> dv;
-  vector<double> dt;
-  getCentralDifferenceDerivative(1., v, dv);
-  getCentralDifferenceDerivative(1., t, dt);
-  transform(dv.begin(), dv.end(), dt.begin(), dvdt.begin(), std::divides<double>());
 
   // restrict to time interval where stimulus is applied
   vector<int> minima;
-  int stimbeginindex = distance(
-      t.begin(),
-      find_if(t.begin(), t.end(), bind2nd(greater_equal<double>(), stimstart)));
+  int stimbeginindex = findTimeIndex(t, stimstart);
   minima.push_back(stimbeginindex);
   for (unsigned i = 0; i < ahpi.size(); i++) {
     if (ahpi[i] > stimbeginindex) {
@@ -66,9 +58,7 @@ static int __AP_begin_indices(const vector<double>& t, const vector<double>& v,
   // if the AHP_indices are already restricted make sure that we do not miss
   // the last spike
   if (t[minima.back()] < stimend) {
-    int stimendindex =
-        distance(t.begin(), find_if(t.begin() + minima.back(), t.end(),
-                                    bind2nd(greater_equal<double>(), stimend)));
+    int stimendindex = findTimeIndex(t, stimend, minima.back());
     minima.push_back(stimendindex);
   }
   for (unsigned i = 0; i < minima.size() - 1; i++) {
@@ -108,12 +98,9 @@ int LibV2::AP_begin_indices(mapStr2intVec& IntFeatureData,
   if (retVal) {
     return nSize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
-  vector<double> v;
-  retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
-  if (retVal < 0) return -1;
   vector<double> stimstart;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "stim_start", stimstart);
   if (retVal < 0) return -1;
@@ -123,10 +110,13 @@ int LibV2::AP_begin_indices(mapStr2intVec& IntFeatureData,
   vector<int> ahpi;
   retVal = getIntVec(IntFeatureData, StringData, "min_AHP_indices", ahpi);
   if (retVal < 0) return -1;
+  ConstVecRef<double> dvdt;
+  retVal = getVoltageDerivative(DoubleFeatureData, StringData, 1, dvdt);
+  if (retVal < 0) return -1;
   vector<int> apbi;
-  retVal = __AP_begin_indices(t, v, stimstart[0], stimend[0], ahpi, apbi);
+  retVal = __AP_begin_indices(t, dvdt, stimstart[0], stimend[0], ahpi, apbi);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_begin_indices", apbi);
+    setIntVec(IntFeatureData, StringData, "AP_begin_indices", std::move(apbi));
   }
   return retVal;
 }
@@ -165,10 +155,10 @@ int LibV2::AP_end_indices(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<int> pi;
@@ -177,7 +167,7 @@ int LibV2::AP_end_indices(mapStr2intVec& IntFeatureData,
   vector<int> apei;
   retVal = __AP_end_indices(t, v, pi, apei);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_end_indices", apei);
+    setIntVec(IntFeatureData, StringData, "AP_end_indices", std::move(apei));
   }
   return retVal;
 }
@@ -216,7 +206,7 @@ int LibV2::AP_rise_indices(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<int> apbi;
@@ -228,7 +218,7 @@ int LibV2::AP_rise_indices(mapStr2intVec& IntFeatureData,
   vector<int> apri;
   retVal = __AP_rise_indices(v, apbi, pi, apri);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_rise_indices", apri);
+    setIntVec(IntFeatureData, StringData, "AP_rise_indices", std::move(apri));
   }
   return retVal;
 }
@@ -261,7 +251,7 @@ int LibV2::AP_fall_indices(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<int> apbi;
@@ -276,7 +266,7 @@ int LibV2::AP_fall_indices(mapStr2intVec& IntFeatureData,
   vector<int> apfi;
   retVal = __AP_fall_indices(v, apbi, apei, pi, apfi);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_fall_indices", apfi);
+    setIntVec(IntFeatureData, StringData, "AP_fall_indices", std::move(apfi));
   }
   return retVal;
 }
@@ -305,7 +295,7 @@ int LibV2::AP_duration(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
   vector<int> apbeginindices;
@@ -319,7 +309,8 @@ int LibV2::AP_duration(mapStr2intVec& IntFeatureData,
   vector<double> apduration;
   retval = __AP_duration(t, apbeginindices, endindices, apduration);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_duration", apduration);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_duration",
+                 std::move(apduration));
   }
   return retval;
 }
@@ -346,7 +337,7 @@ int LibV2::AP_duration_half_width(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
   vector<int> apriseindices;
@@ -389,7 +380,7 @@ int LibV2::AP_rise_time(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
   vector<int> apbeginindices;
@@ -403,7 +394,8 @@ int LibV2::AP_rise_time(mapStr2intVec& IntFeatureData,
   vector<double> aprisetime;
   retval = __AP_rise_time(t, apbeginindices, peakindices, aprisetime);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_rise_time", aprisetime);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_rise_time",
+                 std::move(aprisetime));
   }
   return retval;
 }
@@ -430,7 +422,7 @@ int LibV2::AP_fall_time(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
   vector<int> peakindices;
@@ -444,7 +436,8 @@ int LibV2::AP_fall_time(mapStr2intVec& IntFeatureData,
   vector<double> apfalltime;
   retval = __AP_fall_time(t, peakindices, apendindices, apfalltime);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_fall_time", apfalltime);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_fall_time",
+                 std::move(apfalltime));
   }
   return retval;
 }
@@ -472,10 +465,10 @@ int LibV2::AP_rise_rate(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
   vector<int> apbeginindices;
@@ -489,7 +482,8 @@ int LibV2::AP_rise_rate(mapStr2intVec& IntFeatureData,
   vector<double> apriserate;
   retval = __AP_rise_rate(t, v, apbeginindices, peakindices, apriserate);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_rise_rate", apriserate);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_rise_rate",
+                 std::move(apriserate));
   }
   return retval;
 }
@@ -517,10 +511,10 @@ int LibV2::AP_fall_rate(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
   vector<int> peakindices;
@@ -533,7 +527,8 @@ int LibV2::AP_fall_rate(mapStr2intVec& IntFeatureData,
   vector<double> apfallrate;
   retval = __AP_fall_rate(t, v, peakindices, apendindices, apfallrate);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_fall_rate", apfallrate);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_fall_rate",
+                 std::move(apfallrate));
   }
   return retval;
 }
@@ -562,7 +557,7 @@ int LibV2::fast_AHP(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
   vector<int> apbeginindices;
@@ -576,7 +571,7 @@ int LibV2::fast_AHP(mapStr2intVec& IntFeatureData,
   vector<double> fastahp;
   retval = __fast_AHP(v, apbeginindices, minahpindices, fastahp);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "fast_AHP", fastahp);
+    setDoubleVec(DoubleFeatureData, StringData, "fast_AHP", std::move(fastahp));
   }
   return retval;
 }
@@ -816,7 +811,7 @@ int LibV2::E6(mapStr2intVec& IntFeatureData,
                               0, e6);
   if (retval >= 0) {
     e6.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E6", e6);
+    setDoubleVec(DoubleFeatureData, StringData, "E6", std::move(e6));
   }
   return retval;
 }
@@ -836,7 +831,7 @@ int LibV2::E7(mapStr2intVec& IntFeatureData,
       mean_traces_double(DoubleFeatureData, "AP_duration", "APWaveForm", 0, e7);
   if (retval >= 0) {
     e7.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E7", e7);
+    setDoubleVec(DoubleFeatureData, StringData, "E7", std::move(e7));
   }
   return retval;
 }
@@ -881,7 +876,7 @@ int LibV2::BPAPatt2(mapStr2intVec& IntFeatureData,
   // action potential:
   // the height of the dendritic spike
   bpapatt.push_back(*max_element(v_dend.begin(), v_dend.end()) - vb_dend[0]);
-  setDoubleVec(DoubleFeatureData, StringData, "BPAPatt2", bpapatt);
+  setDoubleVec(DoubleFeatureData, StringData, "BPAPatt2", std::move(bpapatt));
   return retval;
 }
 // end of BPAPatt2
@@ -925,7 +920,7 @@ int LibV2::BPAPatt3(mapStr2intVec& IntFeatureData,
   // action potential:
   // the height of the dendritic spike
   bpapatt.push_back(*max_element(v_dend.begin(), v_dend.end()) - vb_dend[0]);
-  setDoubleVec(DoubleFeatureData, StringData, "BPAPatt3", bpapatt);
+  setDoubleVec(DoubleFeatureData, StringData, "BPAPatt3", std::move(bpapatt));
   return retval;
 }
 // end of BPAPatt3
@@ -954,12 +949,21 @@ int LibV2::E39(mapStr2intVec& IntFeatureData,
       // retrieve the trace data
       // note that we call getDoubleParam with suffix appended,
       // this is the direct access to the global map
-      getDoubleParam(DoubleFeatureData, "stimulus_current" + stim_params[i],
-                     stimulus_current);
+      if (getDoubleParam(DoubleFeatureData,
+                         "stimulus_current" + stim_params[i],
+                         stimulus_current) < 1) {
+        GErrorStr += "\nMissing stimulus_current" + stim_params[i] +
+                     " for calculation of E39";
+        return -1;
+      }
       current[i] = stimulus_current[0];
       vector<double> freq;
-      getDoubleParam(DoubleFeatureData, "mean_frequency" + stim_params[i],
-                     freq);
+      if (getDoubleParam(DoubleFeatureData, "mean_frequency" + stim_params[i],
+                         freq) < 1) {
+        GErrorStr += "\nMissing mean_frequency" + stim_params[i] +
+                     " for calculation of E39";
+        return -1;
+      }
       frequency[i] = freq[0];
     }
     linear_fit_result fit;
@@ -1035,7 +1039,7 @@ int LibV2::E2(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "amp_drop_first_second",
                               "APDrop", 0, e2);
   if (retval > 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E2", e2);
+    setDoubleVec(DoubleFeatureData, StringData, "E2", std::move(e2));
     return 1;
   }
   return retval;
@@ -1089,7 +1093,7 @@ int LibV2::E3(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "amp_drop_first_last",
                               "APDrop", 0, e3);
   if (retval > 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E3", e3);
+    setDoubleVec(DoubleFeatureData, StringData, "E3", std::move(e3));
     return 1;
   }
   return retval;
@@ -1143,7 +1147,7 @@ int LibV2::E4(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "amp_drop_second_last",
                               "APDrop", 0, e4);
   if (retval > 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E4", e4);
+    setDoubleVec(DoubleFeatureData, StringData, "E4", std::move(e4));
     return 1;
   }
   return retval;
@@ -1207,7 +1211,7 @@ int LibV2::E5(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "max_amp_difference", "APDrop",
                               0, e5);
   if (retval > 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E5", e5);
+    setDoubleVec(DoubleFeatureData, StringData, "E5", std::move(e5));
     return 1;
   }
   return retval;
@@ -1228,7 +1232,7 @@ int LibV2::E8(mapStr2intVec& IntFeatureData,
                               "APWaveForm", 0, e8);
   if (retval >= 0) {
     e8.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E8", e8);
+    setDoubleVec(DoubleFeatureData, StringData, "E8", std::move(e8));
   }
   return retval;
 }
@@ -1248,7 +1252,7 @@ int LibV2::E9(mapStr2intVec& IntFeatureData,
                               0, e9);
   if (retval >= 0) {
     e9.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E9", e9);
+    setDoubleVec(DoubleFeatureData, StringData, "E9", std::move(e9));
   }
   return retval;
 }
@@ -1269,7 +1273,7 @@ int LibV2::E10(mapStr2intVec& IntFeatureData,
                               0, e10);
   if (retval >= 0) {
     e10.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E10", e10);
+    setDoubleVec(DoubleFeatureData, StringData, "E10", std::move(e10));
   }
   return retval;
 }
@@ -1290,7 +1294,7 @@ int LibV2::E11(mapStr2intVec& IntFeatureData,
                               0, e11);
   if (retval >= 0) {
     e11.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E11", e11);
+    setDoubleVec(DoubleFeatureData, StringData, "E11", std::move(e11));
   }
   return retval;
 }
@@ -1311,7 +1315,7 @@ int LibV2::E12(mapStr2intVec& IntFeatureData,
                               0, e12);
   if (retval >= 0) {
     e12.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E12", e12);
+    setDoubleVec(DoubleFeatureData, StringData, "E12", std::move(e12));
   }
   return retval;
 }
@@ -1332,7 +1336,7 @@ int LibV2::E13(mapStr2intVec& IntFeatureData,
       mean_traces_double(DoubleFeatureData, "fast_AHP", "APWaveForm", 0, e13);
   if (retval >= 0) {
     e13.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E13", e13);
+    setDoubleVec(DoubleFeatureData, StringData, "E13", std::move(e13));
   }
   return retval;
 }
@@ -1354,7 +1358,7 @@ int LibV2::E14(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e14[0] = e14[1];
     e14.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E14", e14);
+    setDoubleVec(DoubleFeatureData, StringData, "E14", std::move(e14));
   }
   return retval;
 }
@@ -1376,7 +1380,7 @@ int LibV2::E15(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e15[0] = e15[1];
     e15.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E15", e15);
+    setDoubleVec(DoubleFeatureData, StringData, "E15", std::move(e15));
   }
   return retval;
 }
@@ -1398,7 +1402,7 @@ int LibV2::E16(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e16[0] = e16[1];
     e16.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E16", e16);
+    setDoubleVec(DoubleFeatureData, StringData, "E16", std::move(e16));
   }
   return retval;
 }
@@ -1420,7 +1424,7 @@ int LibV2::E17(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e17[0] = e17[1];
     e17.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E17", e17);
+    setDoubleVec(DoubleFeatureData, StringData, "E17", std::move(e17));
   }
   return retval;
 }
@@ -1442,7 +1446,7 @@ int LibV2::E18(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e18[0] = e18[1];
     e18.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E18", e18);
+    setDoubleVec(DoubleFeatureData, StringData, "E18", std::move(e18));
   }
   return retval;
 }
@@ -1464,7 +1468,7 @@ int LibV2::E19(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e19[0] = e19[1];
     e19.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E19", e19);
+    setDoubleVec(DoubleFeatureData, StringData, "E19", std::move(e19));
   }
   return retval;
 }
@@ -1486,7 +1490,7 @@ int LibV2::E20(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e20[0] = e20[1];
     e20.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E20", e20);
+    setDoubleVec(DoubleFeatureData, StringData, "E20", std::move(e20));
   }
   return retval;
 }
@@ -1508,7 +1512,7 @@ int LibV2::E21(mapStr2intVec& IntFeatureData,
   if (retval >= 0) {
     e21[0] = e21[1];
     e21.resize(1);
-    setDoubleVec(DoubleFeatureData, StringData, "E21", e21);
+    setDoubleVec(DoubleFeatureData, StringData, "E21", std::move(e21));
   }
   return retval;
 }
@@ -1528,7 +1532,7 @@ int LibV2::E22(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "AP_amplitude_change",
                               "APWaveForm", 0, e22);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E22", e22);
+    setDoubleVec(DoubleFeatureData, StringData, "E22", std::move(e22));
   }
   return retval;
 }
@@ -1548,7 +1552,7 @@ int LibV2::E23(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "AP_duration_change",
                               "APWaveForm", 0, e23);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E23", e23);
+    setDoubleVec(DoubleFeatureData, StringData, "E23", std::move(e23));
   }
   return retval;
 }
@@ -1568,7 +1572,7 @@ int LibV2::E24(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(
       DoubleFeatureData, "AP_duration_half_width_change", "APWaveForm", 0, e24);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E24", e24);
+    setDoubleVec(DoubleFeatureData, StringData, "E24", std::move(e24));
   }
   return retval;
 }
@@ -1588,7 +1592,7 @@ int LibV2::E25(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "AP_rise_rate_change",
                               "APWaveForm", 0, e25);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E25", e25);
+    setDoubleVec(DoubleFeatureData, StringData, "E25", std::move(e25));
   }
   return retval;
 }
@@ -1608,7 +1612,7 @@ int LibV2::E26(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "AP_fall_rate_change",
                               "APWaveForm", 0, e26);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E26", e26);
+    setDoubleVec(DoubleFeatureData, StringData, "E26", std::move(e26));
   }
   return retval;
 }
@@ -1628,7 +1632,7 @@ int LibV2::E27(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "fast_AHP_change",
                               "APWaveForm", 0, e27);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E27", e27);
+    setDoubleVec(DoubleFeatureData, StringData, "E27", std::move(e27));
   }
   return retval;
 }
@@ -1640,10 +1644,7 @@ int LibV2::E27(mapStr2intVec& IntFeatureData,
 static int __steady_state_hyper(const vector<double>& v,
                                 const vector<double>& t, double stimend,
                                 vector<double>& steady_state_hyper) {
-  int i_end =
-      distance(t.begin(), find_if(t.begin(), t.end(),
-                                  bind2nd(greater_equal<double>(), stimend))) -
-      5;
+  int i_end = static_cast<int>(findTimeIndex(t, stimend)) - 5;
 
   const int offset = 30;
   if (i_end < 0 || i_end < offset) {
@@ -1673,10 +1674,10 @@ int LibV2::steady_state_hyper(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
   vector<double> stimend;
@@ -1705,7 +1706,7 @@ int LibV2::E40(mapStr2intVec& IntFeatureData,
   retval = mean_traces_double(DoubleFeatureData, "time_to_first_spike",
                               "IDrest", 0, e40);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "E40", e40);
+    setDoubleVec(DoubleFeatureData, StringData, "E40", std::move(e40));
   }
   return retval;
 }
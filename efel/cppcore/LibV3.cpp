@@ -38,7 +38,8 @@ int LibV3::interpolate(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> V, T, VIntrpol, TIntrpol, InterpStepVec;
+  vector<double> VIntrpol, TIntrpol, InterpStepVec;
+  ConstVecRef<double> V, T;
   vector<int> intrpolte;
   double InterpStep;
   // getDoubleVec takes care of stimulus suffix
@@ -54,11 +55,16 @@ int LibV3::interpolate(mapStr2intVec& IntFeatureData,
   else
     InterpStep = InterpStepVec[0];
 
-  LinearInterpolation(InterpStep, T, V, TIntrpol, VIntrpol);
+  // Traces that are already sampled at interp_step, like simulator output
+  // recorded at that step, are used as they are instead of being resampled
+  // into a copy
+  if (V.size() != T.size() || !isInterpolationGrid(InterpStep, T)) {
+    LinearInterpolation(InterpStep, T, V, TIntrpol, VIntrpol);
 
-  setDoubleVec(DoubleFeatureData, StringData, "V", VIntrpol);
-  setDoubleVec(DoubleFeatureData, StringData, "T", TIntrpol);
-  setIntVec(IntFeatureData, StringData, "interpolate", intrpolte);
+    setDoubleVec(DoubleFeatureData, StringData, "V", std::move(VIntrpol));
+    setDoubleVec(DoubleFeatureData, StringData, "T", std::move(TIntrpol));
+  }
+  setIntVec(IntFeatureData, StringData, "interpolate", std::move(intrpolte));
   return retVal;
 }
 
@@ -102,35 +108,15 @@ int LibV3::trace_check(mapStr2intVec& IntFeatureData,
   }
 }
 
-static int __peak_indices(double dThreshold, vector<double>& V,
+static int __peak_indices(double dThreshold, const vector<double>& V,
                           vector<int>& PeakIndex) {
-  vector<int> upVec, dnVec;
-  double dtmp;
-  int itmp;
-  for (unsigned i = 1; i < V.size(); i++) {
-    if (V[i] > dThreshold && V[i - 1] < dThreshold) {
-      upVec.push_back(i);
-    } else if (V[i] < dThreshold && V[i - 1] > dThreshold) {
-        dnVec.push_back(i);
-    }
-  }
-  if ((dnVec.size() != upVec.size()) || (dnVec.size() == 0)) {
+  size_t upCrossings, downCrossings;
+  findThresholdPeaks(V, dThreshold, PeakIndex, upCrossings, downCrossings);
+  if ((downCrossings != upCrossings) || (downCrossings == 0)) {
     GErrorStr += "\nBad Trace Shape.\n";
+    PeakIndex.clear();
     return 0;
   }
-  PeakIndex.clear();
-  int j = 0;
-  for (unsigned i = 0; i < upVec.size(); i++) {
-    dtmp = -1e9;
-    itmp = -1;
-    for (j = upVec[i]; j <= dnVec[i]; j++) {
-      if (dtmp < V[j]) {
-        dtmp = V[j];
-        itmp = j;
-      }
-    }
-    if (itmp != -1) PeakIndex.push_back(itmp);
-  }
   return PeakIndex.size();
 }
 
@@ -145,7 +131,8 @@ int LibV3::peak_indices(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> PeakIndex;
-  vector<double> v, Th;
+  vector<double> Th;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal <= 0) return -1;
   retVal = getDoubleParam(DoubleFeatureData, "Threshold", Th);
@@ -153,7 +140,7 @@ int LibV3::peak_indices(mapStr2intVec& IntFeatureData,
 
   int retval = __peak_indices(Th[0], v, PeakIndex);
   if (retval >= 0)
-    setIntVec(IntFeatureData, StringData, "peak_indices", PeakIndex);
+    setIntVec(IntFeatureData, StringData, "peak_indices", std::move(PeakIndex));
   return retval;
 }
 
@@ -216,7 +203,7 @@ int LibV3::ISI_CV(mapStr2intVec& IntFeatureData,
   vector<double> isicv;
   retval = __ISI_CV(isivalues, isicv);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "ISI_CV", isicv);
+    setDoubleVec(DoubleFeatureData, StringData, "ISI_CV", std::move(isicv));
   }
   return retval;
 }
@@ -234,7 +221,8 @@ int LibV3::peak_voltage(mapStr2intVec& IntFeatureData,
   // vector<int> PeakI = getIntVec(IntFeatureData, StringData,
   // string("peak_indices"));
   vector<int> PeakI;
-  vector<double> V, peakV;
+  vector<double> peakV;
+  ConstVecRef<double> V;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices", PeakI);
   if (retVal <= 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
@@ -293,7 +281,8 @@ int LibV3::peak_time(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> PeakI;
-  vector<double> T, pvTime;
+  vector<double> pvTime;
+  ConstVecRef<double> T;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices", PeakI);
   if (retVal <= 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", T);
@@ -339,9 +328,7 @@ static int __spike_width1(const vector<double>& t, const vector<double>& v,
                           const vector<int>& peak_indices,
                           const vector<int>& min_ahp_indices, double stim_start,
                           vector<double>& spike_width1) {
-  int start_index = distance(
-      t.begin(), find_if(t.begin(), t.end(),
-                         bind2nd(greater_equal<double>(), stim_start)));
+  int start_index = findTimeIndex(t, stim_start);
   vector<int> min_ahp_indices_plus(min_ahp_indices.size() + 1, start_index);
   copy(min_ahp_indices.begin(), min_ahp_indices.end(),
        min_ahp_indices_plus.begin() + 1);
@@ -386,7 +373,8 @@ int LibV3::spike_width1(mapStr2intVec& IntFeatureData,
     return nSize;
 
   vector<int> PeakIndex, minAHPIndex;
-  vector<double> V, t, dv1, dv2, spike_width1;
+  vector<double> dv1, dv2, spike_width1;
+  ConstVecRef<double> V, t;
   vector<double> stim_start;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
@@ -430,10 +418,10 @@ int LibV3::min_AHP_indices(mapStr2intVec& IntFeatureData,
 
   vector<int> peak_indices_plus;
   vector<int> min_ahp_indices;
-  vector<double> v;
+  ConstVecRef<double> v;
   vector<double> min_ahp_values;
   vector<double> stim_end;
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal <= 0) return -1;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices",
@@ -449,9 +437,7 @@ int LibV3::min_AHP_indices(mapStr2intVec& IntFeatureData,
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal <= 0) return -1;
 
-  int end_index = distance(
-      t.begin(), find_if(t.begin(), t.end(),
-                         bind2nd(greater_equal<double>(), stim_end[0])));
+  int end_index = findTimeIndex(t, stim_end[0]);
   // if the last spike happens to be close to the end of the stimulus
   // there will not be a proper AHP, this case is not properly dealt with here
   if (end_index > peak_indices_plus.back() + 5) {
@@ -512,7 +498,8 @@ int LibV3::rest_voltage_value(mapStr2intVec& IntFeatureData,
   if (retVal)
     return nSize;
 
-  vector<double> v, t, stimStart, vRest;
+  vector<double> stimStart, vRest;
+  ConstVecRef<double> v, t;
   double startTime, endTime;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
@@ -527,18 +514,16 @@ int LibV3::rest_voltage_value(mapStr2intVec& IntFeatureData,
   endTime = stimStart[0] * .75;
   int nCount = 0;
   double vSum = 0;
-  // calculte the mean of voltage between startTime and endTime
-  for (size_t i = 0; i < t.size(); i++) {
-    if (t[i] >= startTime) {
-      vSum = vSum + v[i];
-      nCount++;
-    }
-    if (t[i] > endTime) {
-      break;
-    }
+  // calculte the mean of voltage between startTime and endTime, the first
+  // point after endTime included
+  const size_t endIndex =
+      std::min(findTimeIndexAfter(t, endTime) + 1, t.size());
+  for (size_t i = findTimeIndex(t, startTime); i < endIndex; i++) {
+    vSum = vSum + v[i];
+    nCount++;
   }
   vRest.push_back(vSum / nCount);
-  setDoubleVec(DoubleFeatureData, StringData, "voltage_base", vRest);
+  setDoubleVec(DoubleFeatureData, StringData, "voltage_base", std::move(vRest));
   return 1;
 }
 
@@ -663,7 +648,7 @@ int LibV3::AP_amplitude(mapStr2intVec& IntFeatureData,
 
   vector<double> peakvoltage;
   vector<int> apbeginindices;
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal <= 0) { return -1; }
   retVal = getDoubleVec(DoubleFeatureData, StringData, "peak_voltage",
@@ -699,9 +684,7 @@ static int __AP_width(const vector<double>& t, const vector<double>& v,
   //   printVectorI("minahpindices", minahpindices);
   //   printf("\nStimStart = %f , thereshold = %f ", stimstart, threshold);
   vector<int> indices(minahpindices.size() + 1);
-  int start_index = distance(
-      t.begin(),
-      find_if(t.begin(), t.end(), bind2nd(greater_equal<double>(), stimstart)));
+  int start_index = findTimeIndex(t, stimstart);
   indices[0] = start_index;
   copy(minahpindices.begin(), minahpindices.end(), indices.begin() + 1);
   for (unsigned i = 0; i < indices.size() - 1; i++) {
@@ -739,10 +722,10 @@ int LibV3::AP_width(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retval < 0) return -1;
   vector<double> threshold;
@@ -764,7 +747,7 @@ int LibV3::AP_width(mapStr2intVec& IntFeatureData,
   retval = __AP_width(t, v, stimstart[0], threshold[0], peakindices,
                       minahpindices, apwidth);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_width", apwidth);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_width", std::move(apwidth));
   }
   return retval;
 }
@@ -798,24 +781,17 @@ int LibV3::doublet_ISI(mapStr2intVec& IntFeatureData,
 //
 // *** AP begin indices ***
 //
-static int __AP_begin_indices(const vector<double>& t, const vector<double>& v,
-                              double stimstart, double stimend,
-                              const vector<int>& ahpi, vector<int>& apbi) {
+static int __AP_begin_indices(const vector<double>& t,
+                              const vector<double>& dvdt, double stimstart,
+                              double stimend, const vector<int>& ahpi,
+                              vector<int>& apbi) {
   // derivative at peak start according to eCode specification 10mV/ms
   // according to Shaul 12mV/ms
   const double derivativethreshold = 12.;
-  vector<double> dvdt(v.size());
-  vector<double> dv;
-  vector<double> dt;
-  getCentralDifferenceDerivative(1., v, dv);
-  getCentralDifferenceDerivative(1., t, dt);
-  transform(dv.begin(), dv.end(), dt.begin(), dvdt.begin(), std::divides<double>());
 
   // restrict to time interval where stimulus is applied
   vector<int> minima;
-  int stimbeginindex = distance(
-      t.begin(),
-      find_if(t.begin(), t.end(), bind2nd(greater_equal<double>(), stimstart)));
+  int stimbeginindex = findTimeIndex(t, stimstart);
   minima.push_back(stimbeginindex);
   for (unsigned i = 0; i < ahpi.size(); i++) {
     if (ahpi[i] > stimbeginindex) {
@@ -828,9 +804,7 @@ static int __AP_begin_indices(const vector<double>& t, const vector<double>& v,
   // if the AHP_indices are already restricted make sure that we do not miss
   // the last spike
   if (t[minima.back()] < stimend) {
-    int stimendindex =
-        distance(t.begin(), find_if(t.begin() + minima.back(), t.end(),
-                                    bind2nd(greater_equal<double>(), stimend)));
+    int stimendindex = findTimeIndex(t, stimend, minima.back());
     minima.push_back(stimendindex);
   }
   for (unsigned i = 0; i < minima.size() - 1; i++) {
@@ -870,12 +844,9 @@ int LibV3::AP_begin_indices(mapStr2intVec& IntFeatureData,
   if (retVal) {
     return nSize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
-  vector<double> v;
-  retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
-  if (retVal < 0) return -1;
   vector<double> stimstart;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "stim_start", stimstart);
   if (retVal < 0) return -1;
@@ -885,10 +856,13 @@ int LibV3::AP_begin_indices(mapStr2intVec& IntFeatureData,
   vector<int> ahpi;
   retVal = getIntVec(IntFeatureData, StringData, "min_AHP_indices", ahpi);
   if (retVal < 0) return -1;
+  ConstVecRef<double> dvdt;
+  retVal = getVoltageDerivative(DoubleFeatureData, StringData, 1, dvdt);
+  if (retVal < 0) return -1;
   vector<int> apbi;
-  retVal = __AP_begin_indices(t, v, stimstart[0], stimend[0], ahpi, apbi);
+  retVal = __AP_begin_indices(t, dvdt, stimstart[0], stimend[0], ahpi, apbi);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_begin_indices", apbi);
+    setIntVec(IntFeatureData, StringData, "AP_begin_indices", std::move(apbi));
   }
   return retVal;
 }
@@ -928,10 +902,10 @@ int LibV3::AP_end_indices(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<int> pi;
@@ -940,7 +914,7 @@ int LibV3::AP_end_indices(mapStr2intVec& IntFeatureData,
   vector<int> apei;
   retVal = __AP_end_indices(t, v, pi, apei);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_end_indices", apei);
+    setIntVec(IntFeatureData, StringData, "AP_end_indices", std::move(apei));
   }
   return retVal;
 }
@@ -949,10 +923,15 @@ int LibV3::AP_end_indices(mapStr2intVec& IntFeatureData,
 //
 static int __AP_rise_indices(const vector<double>& v, const vector<int>& apbi,
                              const vector<int>& pi, vector<int>& apri) {
-  apri.resize(apbi.size());
+  apri.resize(std::min(apbi.size(), pi.size()));
   for (unsigned i = 0; i < apri.size(); i++) {
     double halfheight = (v[pi[i]] + v[apbi[i]]) / 2.;
     vector<double> vpeak;
+    if (pi[i] < apbi[i]) {
+      // For some reason the peak and begin indices are out of sync
+      // Peak should always be later than begin index
+      return -1;
+    }
     vpeak.resize(pi[i] - apbi[i]);
     transform(v.begin() + apbi[i], v.begin() + pi[i], vpeak.begin(),
               bind2nd(std::minus<double>(), halfheight));
@@ -974,7 +953,7 @@ int LibV3::AP_rise_indices(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<int> apbi;
@@ -986,7 +965,7 @@ int LibV3::AP_rise_indices(mapStr2intVec& IntFeatureData,
   vector<int> apri;
   retVal = __AP_rise_indices(v, apbi, pi, apri);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_rise_indices", apri);
+    setIntVec(IntFeatureData, StringData, "AP_rise_indices", std::move(apri));
   }
   return retVal;
 }
@@ -996,7 +975,7 @@ int LibV3::AP_rise_indices(mapStr2intVec& IntFeatureData,
 static int __AP_fall_indices(const vector<double>& v, const vector<int>& apbi,
                              const vector<int>& apei, const vector<int>& pi,
                              vector<int>& apfi) {
-  apfi.resize(apbi.size());
+  apfi.resize(std::min(apbi.size(), pi.size()));
   for (unsigned i = 0; i < apfi.size(); i++) {
     double halfheight = (v[pi[i]] + v[apbi[i]]) / 2.;
     vector<double> vpeak(&v[pi[i]], &v[apei[i]]);
@@ -1019,7 +998,7 @@ int LibV3::AP_fall_indices(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<int> apbi;
@@ -1034,7 +1013,7 @@ int LibV3::AP_fall_indices(mapStr2intVec& IntFeatureData,
   vector<int> apfi;
   retVal = __AP_fall_indices(v, apbi, apei, pi, apfi);
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_fall_indices", apfi);
+    setIntVec(IntFeatureData, StringData, "AP_fall_indices", std::move(apfi));
   }
   return retVal;
 }
@@ -1061,7 +1040,7 @@ int LibV3::AP_duration(mapStr2intVec& IntFeatureData,
   if (retval) {
     return nsize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retval < 0) return -1;
   vector<int> apbeginindices;
@@ -1075,7 +1054,8 @@ int LibV3::AP_duration(mapStr2intVec& IntFeatureData,
   vector<double> apduration;
   retval = __AP_duration(t, apbeginindices, endindices, apduration);
   if (retval >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_duration", apduration);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_duration",
+                 std::move(apduration));
   }
   return retval;
 }
@@ -1125,10 +1105,10 @@ int LibV3::depolarized_base(mapStr2intVec& IntFeatureData,
   if (retVal) {
     return nSize;
   }
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
   vector<double> stimstart;
@@ -1148,7 +1128,8 @@ int LibV3::depolarized_base(mapStr2intVec& IntFeatureData,
   retVal = __depolarized_base(t, v, stimstart[0], stimend[0], apbi, apendi,
                               dep_base);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "depolarized_base", dep_base);
+    setDoubleVec(DoubleFeatureData, StringData, "depolarized_base",
+                 std::move(dep_base));
   }
   return retVal;
 }
@@ -73,7 +73,7 @@ int LibV4::peak_indices(mapStr2intVec& IntFeatureData,
   }
 
   vector<int> peakindices;
-  vector<double> v;
+  ConstVecRef<double> v;
   vector<double> min_spike_height;
   vector<double> threshold;
   if (getDoubleVec(DoubleFeatureData, StringData, "V", v) <= 0) {
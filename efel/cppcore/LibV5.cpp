@@ -364,7 +364,8 @@ int LibV5::inv_last_ISI(mapStr2intVec& IntFeatureData,
     inv_last_ISI = 1000.0 / all_isi_values_vec[all_isi_values_vec.size() - 1];
   }
   inv_last_ISI_vec.push_back(inv_last_ISI);
-  setDoubleVec(DoubleFeatureData, StringData, "inv_last_ISI", inv_last_ISI_vec);
+  setDoubleVec(DoubleFeatureData, StringData, "inv_last_ISI",
+               std::move(inv_last_ISI_vec));
   return 1;
 }
 
@@ -403,10 +404,7 @@ static int __min_AHP_indices(const vector<double>& t, const vector<double>& v,
   int end_index = -1;
 
   if (strict_stiminterval) {
-    end_index =
-        distance(t.begin(),
-                 find_if(t.begin(), t.end(),
-                         std::bind2nd(std::greater_equal<double>(), stim_end)));
+    end_index = findTimeIndex(t, stim_end);
   } else {
     end_index = distance(t.begin(), t.end());
   }
@@ -445,7 +443,8 @@ int LibV5::min_AHP_indices(mapStr2intVec& IntFeatureData,
 
   double stim_start, stim_end;
   vector<int> min_ahp_indices, strict_stiminterval_vec, peak_indices;
-  vector<double> v, t, stim_start_vec, stim_end_vec, min_ahp_values;
+  vector<double> stim_start_vec, stim_end_vec, min_ahp_values;
+  ConstVecRef<double> v, t;
   bool strict_stiminterval;
 
   // Get voltage
@@ -497,7 +496,8 @@ int LibV5::min_AHP_indices(mapStr2intVec& IntFeatureData,
                         strict_stiminterval, min_ahp_indices, min_ahp_values);
 
   if (retVal > 0) {
-    setIntVec(IntFeatureData, StringData, "min_AHP_indices", min_ahp_indices);
+    setIntVec(IntFeatureData, StringData, "min_AHP_indices",
+              std::move(min_ahp_indices));
     setDoubleVec(DoubleFeatureData, StringData, "min_AHP_values",
                  min_ahp_values);
   }
@@ -537,10 +537,7 @@ static int __spike_width1(const vector<double>& t, const vector<double>& v,
                           const vector<int>& peak_indices,
                           const vector<int>& min_ahp_indices, double stim_start,
                           vector<double>& spike_width1) {
-  int start_index =
-      distance(t.begin(),
-               find_if(t.begin(), t.end(),
-                       std::bind2nd(std::greater_equal<double>(), stim_start)));
+  int start_index = findTimeIndex(t, stim_start);
   vector<int> min_ahp_indices_plus(min_ahp_indices.size() + 1, start_index);
   copy(min_ahp_indices.begin(), min_ahp_indices.end(),
        min_ahp_indices_plus.begin() + 1);
@@ -584,7 +581,8 @@ int LibV5::spike_width1(mapStr2intVec& IntFeatureData,
   if (retVal) return nSize;
 
   vector<int> PeakIndex, minAHPIndex;
-  vector<double> V, t, dv1, dv2, spike_width1;
+  vector<double> dv1, dv2, spike_width1;
+  ConstVecRef<double> V, t;
   vector<double> stim_start;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
@@ -620,18 +618,12 @@ int LibV5::spike_width1(mapStr2intVec& IntFeatureData,
 //
 // *** AP begin indices ***
 //
-static int __AP_begin_indices(const vector<double>& t, const vector<double>& v,
-                              double stimstart, double stimend,
-                              const vector<int>& ahpi, vector<int>& apbi,
-                              double dTh, int derivative_window) {
+static int __AP_begin_indices(const vector<double>& t,
+                              const vector<double>& dvdt, double stimstart,
+                              double stimend, const vector<int>& ahpi,
+                              vector<int>& apbi, double dTh,
+                              int derivative_window) {
   const double derivativethreshold = dTh;
-  vector<double> dvdt(v.size());
-  vector<double> dv;
-  vector<double> dt;
-  getCentralDifferenceDerivative(1., v, dv);
-  getCentralDifferenceDerivative(1., t, dt);
-  transform(dv.begin(), dv.end(), dt.begin(), dvdt.begin(),
-            std::divides<double>());
 
   /*for (unsigned i = 0; i < dvdt.size(); i++) {
       printf("%d %f %f\n", i, dvdt[i]);
@@ -640,10 +632,7 @@ static int __AP_begin_indices(const vector<double>& t, const vector<double>& v,
 
   // restrict to time interval where stimulus is applied
   vector<int> minima;
-  int stimbeginindex =
-      distance(t.begin(),
-               find_if(t.begin(), t.end(),
-                       std::bind2nd(std::greater_equal<double>(), stimstart)));
+  int stimbeginindex = findTimeIndex(t, stimstart);
   minima.push_back(stimbeginindex);
   for (unsigned i = 0; i < ahpi.size(); i++) {
     if (ahpi[i] > stimbeginindex) {
@@ -707,12 +696,9 @@ int LibV5::AP_begin_indices(mapStr2intVec& IntFeatureData,
   }
 
   // Get input parameters
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
-  vector<double> v;
-  retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
-  if (retVal < 0) return -1;
   vector<double> stimstart;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "stim_start", stimstart);
   if (retVal < 0) return -1;
@@ -741,13 +727,17 @@ int LibV5::AP_begin_indices(mapStr2intVec& IntFeatureData,
     return -1;
   }
   
+  ConstVecRef<double> dvdt;
+  retVal = getVoltageDerivative(DoubleFeatureData, StringData, 1, dvdt);
+  if (retVal < 0) return -1;
+
   // Calculate feature
-  retVal =
-      __AP_begin_indices(t, v, stimstart[0], stimend[0], ahpi, apbi, dTh[0], derivative_window[0]);
+  retVal = __AP_begin_indices(t, dvdt, stimstart[0], stimend[0], ahpi, apbi,
+                              dTh[0], derivative_window[0]);
 
   // Save feature value
   if (retVal >= 0) {
-    setIntVec(IntFeatureData, StringData, "AP_begin_indices", apbi);
+    setIntVec(IntFeatureData, StringData, "AP_begin_indices", std::move(apbi));
   }
   return retVal;
 }
@@ -860,7 +850,7 @@ int LibV5::AP1_amp(mapStr2intVec& IntFeatureData,
     AP1_amp.push_back(AP_amplitudes[0]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP1_amp", AP1_amp);
+  setDoubleVec(DoubleFeatureData, StringData, "AP1_amp", std::move(AP1_amp));
   return 1;
 }
 
@@ -883,7 +873,8 @@ int LibV5::APlast_amp(mapStr2intVec& IntFeatureData,
     APlast_amp.push_back(AP_amplitudes[AP_amplitude_size - 1]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "APlast_amp", APlast_amp);
+  setDoubleVec(DoubleFeatureData, StringData, "APlast_amp",
+               std::move(APlast_amp));
   return 1;
 }
 
@@ -905,7 +896,7 @@ int LibV5::AP1_peak(mapStr2intVec& IntFeatureData,
     AP1_peak.push_back(peak_voltage[0]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP1_peak", AP1_peak);
+  setDoubleVec(DoubleFeatureData, StringData, "AP1_peak", std::move(AP1_peak));
   return 1;
 }
 
@@ -927,7 +918,7 @@ int LibV5::AP2_amp(mapStr2intVec& IntFeatureData,
     AP2_amp.push_back(AP_amplitudes[1]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP2_amp", AP2_amp);
+  setDoubleVec(DoubleFeatureData, StringData, "AP2_amp", std::move(AP2_amp));
 
   return 1;
 }
@@ -950,7 +941,7 @@ int LibV5::AP2_peak(mapStr2intVec& IntFeatureData,
     AP2_peak.push_back(peak_voltage[1]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP2_peak", AP2_peak);
+  setDoubleVec(DoubleFeatureData, StringData, "AP2_peak", std::move(AP2_peak));
   return 1;
 }
 
@@ -973,7 +964,8 @@ int LibV5::AP2_AP1_diff(mapStr2intVec& IntFeatureData,
     AP2_AP1_diff.push_back(AP_amplitudes[1] - AP_amplitudes[0]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP2_AP1_diff", AP2_AP1_diff);
+  setDoubleVec(DoubleFeatureData, StringData, "AP2_AP1_diff",
+               std::move(AP2_AP1_diff));
 
   return 1;
 }
@@ -1020,7 +1012,8 @@ int LibV5::AP1_width(mapStr2intVec& IntFeatureData,
     AP1_width.push_back(spike_half_width[0]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP1_width", AP1_width);
+  setDoubleVec(DoubleFeatureData, StringData, "AP1_width",
+               std::move(AP1_width));
 
   return 1;
 }
@@ -1043,7 +1036,8 @@ int LibV5::AP2_width(mapStr2intVec& IntFeatureData,
     AP2_width.push_back(spike_half_width[1]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "AP2_width", AP2_width);
+  setDoubleVec(DoubleFeatureData, StringData, "AP2_width",
+               std::move(AP2_width));
 
   return 1;
 }
@@ -1057,7 +1051,8 @@ int LibV5::APlast_width(mapStr2intVec& IntFeatureData,
   if (retVal) return nSize;
   vector<double> spike_half_width, APlast_width;
 
-  unsigned spike_half_width_size = 
+  // getDoubleVec returns -1 if spike_half_width is missing
+  int spike_half_width_size =
       getDoubleVec(DoubleFeatureData, StringData, "spike_half_width",
                         spike_half_width);
   
@@ -1069,7 +1064,8 @@ int LibV5::APlast_width(mapStr2intVec& IntFeatureData,
     APlast_width.push_back(spike_half_width[spike_half_width_size - 1]);
   }
 
-  setDoubleVec(DoubleFeatureData, StringData, "APlast_width", APlast_width);
+  setDoubleVec(DoubleFeatureData, StringData, "APlast_width",
+               std::move(APlast_width));
   return 1;
 }
 
@@ -1096,7 +1092,7 @@ int LibV5::AHP_time_from_peak(mapStr2intVec& IntFeatureData,
     return nsize;
   }
 
-  vector<double> T;
+  ConstVecRef<double> T;
   retval = getDoubleVec(DoubleFeatureData, StringData, "T", T);
   if (retval < 0) return -1;
 
@@ -1141,7 +1137,7 @@ int LibV5::AHP_depth_from_peak(mapStr2intVec& IntFeatureData,
     return nsize;
   }
 
-  vector<double> V;
+  ConstVecRef<double> V;
   retval = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retval < 0) return -1;
 
@@ -1255,7 +1251,8 @@ int LibV5::AP_begin_width(mapStr2intVec& IntFeatureData,
   if (retVal) return nSize;
 
   vector<int> AP_begin_indices, minAHPIndex;
-  vector<double> V, t, dv1, dv2, AP_begin_width;
+  vector<double> dv1, dv2, AP_begin_width;
+  ConstVecRef<double> V, t;
   vector<double> stim_start;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
@@ -1301,7 +1298,8 @@ int LibV5::AP_begin_time(mapStr2intVec& IntFeatureData,
   if (retVal) return nSize;
 
   vector<int> AP_begin_indices;
-  vector<double> V, t, AP_begin_time;
+  vector<double> AP_begin_time;
+  ConstVecRef<double> V, t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
@@ -1312,7 +1310,8 @@ int LibV5::AP_begin_time(mapStr2intVec& IntFeatureData,
 
   retVal = __AP_begin_time(t, V, AP_begin_indices, AP_begin_time);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "AP_begin_time", AP_begin_time);
+    setDoubleVec(DoubleFeatureData, StringData, "AP_begin_time",
+                 std::move(AP_begin_time));
   }
   return retVal;
 }
@@ -1335,7 +1334,8 @@ int LibV5::AP_begin_voltage(mapStr2intVec& IntFeatureData,
   if (retVal) return nSize;
 
   vector<int> AP_begin_indices;
-  vector<double> V, t, AP_begin_voltage;
+  vector<double> AP_begin_voltage;
+  ConstVecRef<double> V, t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", V);
   if (retVal < 0) return -1;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
@@ -1480,25 +1480,19 @@ static int __voltage_deflection_begin(const vector<double>& v,
       range_begin + (stimEnd - stimStart) * (deflection_range_percentage);
   double base = 0.;
   int base_size = 0;
-  for (unsigned i = 0; i < t.size(); i++) {
-    if (t[i] < stimStart) {
-      base += v[i];
-      base_size++;
-    } else {
-      break;
-    }
+  const size_t stim_start_index = findTimeIndex(t, stimStart);
+  for (size_t i = 0; i < stim_start_index; i++) {
+    base += v[i];
+    base_size++;
   }
   base /= base_size;
   double volt = 0;
   int volt_size = 0;
-  for (unsigned i = 0; i < t.size(); i++) {
-    if (t[i] > range_stop) {
-      break;
-    }
-    if (t[i] > range_begin) {
-      volt += v[i];
-      volt_size++;
-    }
+  const size_t range_end_index = findTimeIndexAfter(t, range_stop);
+  for (size_t i = findTimeIndexAfter(t, range_begin); i < range_end_index;
+       i++) {
+    volt += v[i];
+    volt_size++;
   }
   volt /= volt_size;
 
@@ -1515,8 +1509,8 @@ int LibV5::voltage_deflection_begin(mapStr2intVec& IntFeatureData,
                             "voltage_deflection_begin", nSize);
   if (retVal) return nSize;
 
-  vector<double> v;
-  vector<double> t;
+  ConstVecRef<double> v;
+  ConstVecRef<double> t;
   vector<double> stimStart;
   vector<double> stimEnd;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
@@ -1531,7 +1525,8 @@ int LibV5::voltage_deflection_begin(mapStr2intVec& IntFeatureData,
   vector<double> vd;
   retVal = __voltage_deflection_begin(v, t, stimStart[0], stimEnd[0], vd);
   if (retVal >= 0) {
-    setDoubleVec(DoubleFeatureData, StringData, "voltage_deflection_begin", vd);
+    setDoubleVec(DoubleFeatureData, StringData, "voltage_deflection_begin",
+                 std::move(vd));
   }
   return retVal;
 }
@@ -1586,7 +1581,8 @@ int LibV5::voltage_after_stim(mapStr2intVec& IntFeatureData,
                             nSize);
   if (retVal) return nSize;
 
-  vector<double> v, t, stimEnd, vRest;
+  vector<double> stimEnd, vRest;
+  ConstVecRef<double> v, t;
   double startTime, endTime;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
@@ -1599,17 +1595,18 @@ int LibV5::voltage_after_stim(mapStr2intVec& IntFeatureData,
   endTime = stimEnd[0] + (t[t.size() - 1] - stimEnd[0]) * .75;
   int nCount = 0;
   double vSum = 0;
-  // calculte the mean of voltage between startTime and endTime
-  for (unsigned i = 0; i < t.size(); i++) {
-    if (t[i] >= startTime) {
-      vSum = vSum + v[i];
-      nCount++;
-    }
-    if (t[i] > endTime) break;
+  // calculte the mean of voltage between startTime and endTime, the first
+  // point after endTime included
+  const size_t endIndex =
+      std::min(findTimeIndexAfter(t, endTime) + 1, t.size());
+  for (size_t i = findTimeIndex(t, startTime); i < endIndex; i++) {
+    vSum = vSum + v[i];
+    nCount++;
   }
   if (nCount == 0) return -1;
   vRest.push_back(vSum / nCount);
-  setDoubleVec(DoubleFeatureData, StringData, "voltage_after_stim", vRest);
+  setDoubleVec(DoubleFeatureData, StringData, "voltage_after_stim",
+               std::move(vRest));
   return 1;
 }
 
@@ -1826,7 +1823,7 @@ int LibV5::check_AISInitiation(mapStr2intVec& IntFeatureData,
   vector<double> apBeginSoma;
   retval = getDoubleParam(DoubleFeatureData, "AP_begin_time", apBeginSoma);
   if (retval <= 0) {
-    printf("Error calculating AP_begin_time\n");
+    GErrorStr += "\nError calculating AP_begin_time\n";
     return -1;
   }
 
@@ -1834,7 +1831,7 @@ int LibV5::check_AISInitiation(mapStr2intVec& IntFeatureData,
   retval = getDoubleParam(DoubleFeatureData, "AP_begin_time;location_AIS",
                           apBeginAIS);
   if (retval <= 0) {
-    printf("Error calculating AP_begin_time\n");
+    GErrorStr += "\nError calculating AP_begin_time;location_AIS\n";
     return -1;
   }
 
@@ -1868,18 +1865,11 @@ int LibV5::check_AISInitiation(mapStr2intVec& IntFeatureData,
 //
 
 static int __AP_phaseslope(const vector<double>& v, const vector<double>& t,
-                           double stimStart, double stimEnd,
-                           vector<double>& ap_phaseslopes, vector<int> apbi,
-                           double range) {
-  vector<double> dvdt(v.size());
-  vector<double> dv;
-  vector<double> dt;
+                           const vector<double>& dvdt, double stimStart,
+                           double stimEnd, vector<double>& ap_phaseslopes,
+                           vector<int> apbi, double range) {
   int apbegin_index, range_max_index, range_min_index;
   double ap_phaseslope;
-  getCentralDifferenceDerivative(1., v, dv);
-  getCentralDifferenceDerivative(1., t, dt);
-  transform(dv.begin(), dv.end(), dt.begin(), dvdt.begin(),
-            std::divides<double>());
 
   for (unsigned i = 0; i < apbi.size(); i++) {
     apbegin_index = apbi[i];
@@ -1911,11 +1901,11 @@ int LibV5::AP_phaseslope(mapStr2intVec& IntFeatureData,
       CheckInDoublemap(DoubleFeatureData, StringData, "AP_phaseslope", nSize);
   if (retVal) return nSize;
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
 
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) return -1;
 
@@ -1936,9 +1926,13 @@ int LibV5::AP_phaseslope(mapStr2intVec& IntFeatureData,
   retVal = getIntVec(IntFeatureData, StringData, "AP_begin_indices", apbi);
   if (retVal < 0) return -1;
 
+  ConstVecRef<double> dvdt;
+  retVal = getVoltageDerivative(DoubleFeatureData, StringData, 1, dvdt);
+  if (retVal < 0) return -1;
+
   vector<double> ap_phaseslopes;
-  retVal = __AP_phaseslope(v, t, stimStart[0], stimEnd[0], ap_phaseslopes, apbi,
-                           range_param[0]);
+  retVal = __AP_phaseslope(v, t, dvdt, stimStart[0], stimEnd[0],
+                           ap_phaseslopes, apbi, range_param[0]);
   if (retVal >= 0) {
     setDoubleVec(DoubleFeatureData, StringData, "AP_phaseslope",
                  ap_phaseslopes);
@@ -1986,7 +1980,7 @@ int LibV5::BAC_width(mapStr2intVec& IntFeatureData,
         "\n More than one spike found a location_epsp for BAC_width.\n";
     return -1;
   }
-  setDoubleVec(DoubleFeatureData, StringData, "BAC_width", ap_width);
+  setDoubleVec(DoubleFeatureData, StringData, "BAC_width", std::move(ap_width));
 
   return retVal;
 }
@@ -2080,7 +2074,7 @@ int LibV5::min_voltage_between_spikes(mapStr2intVec& IntFeatureData,
   if (retVal > 0) return nSize;
 
   vector<int> peak_indices;
-  vector<double> v;
+  ConstVecRef<double> v;
   vector<double> min_voltage_between_spikes;
   retVal = getIntVec(IntFeatureData, StringData, "peak_indices", peak_indices);
   if (retVal < 0) {
@@ -2116,7 +2110,7 @@ int LibV5::voltage(mapStr2intVec& IntFeatureData,
   retVal = CheckInDoublemap(DoubleFeatureData, StringData, "voltage", nSize);
   if (retVal > 0) return nSize;
 
-  vector<double> v;
+  ConstVecRef<double> v;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) {
     GErrorStr += "Error getting V for voltage";
@@ -2135,7 +2129,7 @@ int LibV5::time(mapStr2intVec& IntFeatureData,
   retVal = CheckInDoublemap(DoubleFeatureData, StringData, "time", nSize);
   if (retVal > 0) return nSize;
 
-  vector<double> t;
+  ConstVecRef<double> t;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", t);
   if (retVal < 0) {
     GErrorStr += "Error getting T for voltage";
@@ -2152,7 +2146,8 @@ int LibV5::steady_state_voltage_stimend(mapStr2intVec& IntFeatureData,
                                         mapStr2Str& StringData) {
   int retVal;
   int nSize;
-  vector<double> t, v, stimEnd, stimStart, ssv;
+  vector<double> stimEnd, stimStart, ssv;
+  ConstVecRef<double> t, v;
 
   retVal = CheckInDoublemap(DoubleFeatureData, StringData,
                             "steady_state_voltage_stimend", nSize);
@@ -2170,14 +2165,8 @@ int LibV5::steady_state_voltage_stimend(mapStr2intVec& IntFeatureData,
   if (retVal < 0) return -1;
 
   double start_time = stimEnd[0] - 0.1 * (stimEnd[0] - stimStart[0]);
-  unsigned start_index =
-      distance(t.begin(),
-               find_if(t.begin(), t.end(),
-                       std::bind2nd(std::greater_equal<double>(), start_time)));
-  unsigned stop_index =
-      distance(t.begin(),
-               find_if(t.begin(), t.end(),
-                       std::bind2nd(std::greater_equal<double>(), stimEnd[0])));
+  unsigned start_index = findTimeIndex(t, start_time);
+  unsigned stop_index = findTimeIndex(t, stimEnd[0]);
 
   unsigned mean_size = 0;
   double mean = 0.0;
@@ -2208,7 +2197,8 @@ int LibV5::voltage_base(mapStr2intVec& IntFeatureData,
       CheckInDoublemap(DoubleFeatureData, StringData, "voltage_base", nSize);
   if (retVal) return nSize;
 
-  vector<double> v, t, stimStart, vRest, vb_start_perc_vec, vb_end_perc_vec;
+  vector<double> stimStart, vRest, vb_start_perc_vec, vb_end_perc_vec;
+  ConstVecRef<double> v, t;
   double startTime, endTime, vb_start_perc, vb_end_perc;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", v);
   if (retVal < 0) return -1;
@@ -2242,13 +2232,10 @@ int LibV5::voltage_base(mapStr2intVec& IntFeatureData,
   int nCount = 0;
   double vSum = 0;
   // calculte the mean of voltage between startTime and endTime
-  for (unsigned i = 0; i < t.size(); i++) {
-    if (t[i] > endTime) break;
-
-    if (t[i] >= startTime) {
-      vSum = vSum + v[i];
-      nCount++;
-    }
+  const size_t endIndex = findTimeIndexAfter(t, endTime);
+  for (size_t i = findTimeIndex(t, startTime); i < endIndex; i++) {
+    vSum = vSum + v[i];
+    nCount++;
   }
 
   if (nCount == 0) {
@@ -2258,48 +2245,41 @@ int LibV5::voltage_base(mapStr2intVec& IntFeatureData,
   }
 
   vRest.push_back(vSum / nCount);
-  setDoubleVec(DoubleFeatureData, StringData, "voltage_base", vRest);
+  setDoubleVec(DoubleFeatureData, StringData, "voltage_base", std::move(vRest));
   return 1;
 }
 
-size_t get_index(const vector<double>& times, double t) {
-  return distance(times.begin(),
-                  find_if(times.begin(), times.end(),
-                          std::bind2nd(std::greater_equal<double>(), t)));
-}
-
 double __decay_time_constant_after_stim(const vector<double>& times,
                                         const vector<double>& voltage,
                                         const double decay_start_after_stim,
                                         const double decay_end_after_stim,
                                         const double stimStart,
                                         const double stimEnd) {
-  const size_t stimStartIdx = get_index(times, stimStart);
+  const size_t stimStartIdx = findTimeIndex(times, stimStart);
   const size_t decayStartIdx =
-      get_index(times, stimEnd + decay_start_after_stim);
+      findTimeIndex(times, stimEnd + decay_start_after_stim);
 
-  const size_t decayEndIdx = get_index(times, stimEnd + decay_end_after_stim);
+  const size_t decayEndIdx =
+      findTimeIndex(times, stimEnd + decay_end_after_stim);
 
   const double reference = voltage[stimStartIdx];
 
   vector<double> decayValues(decayEndIdx - decayStartIdx);
-  vector<double> decayTimes(decayEndIdx - decayStartIdx);
 
   for (size_t i = 0; i != decayValues.size(); ++i) {
-    const double u0 = std::abs(voltage[decayStartIdx + i] - reference);
-
-    decayValues[i] = log(u0);
-    decayTimes[i] = times[decayStartIdx + i];
+    decayValues[i] = std::abs(voltage[decayStartIdx + i] - reference);
   }
 
-  if (decayTimes.size() < 1 || decayValues.size() < 1) {
+  if (decayValues.size() < 1) {
       GErrorStr +=
         "\ndecay_time_constant_after_stim: no data points to calculate this feature\n";
       return -1;
   }
   else {
-      linear_fit_result fit;
-      fit = slope_straight_line_fit(decayTimes, decayValues);
+      // straight line fit of log(decayValues) over the decay times
+      LogLinearFit decay_fit(&times[decayStartIdx], &decayValues[0],
+                             decayValues.size());
+      linear_fit_result fit = decay_fit.fit(0., false);
 
       const double tau = -1.0 / fit.slope;
       return std::abs(tau);
@@ -2319,11 +2299,11 @@ int LibV5::decay_time_constant_after_stim(mapStr2intVec& IntFeatureData,
     return nSize;
   }
 
-  vector<double> voltages;
+  ConstVecRef<double> voltages;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "V", voltages);
   if (retVal < 0) return -1;
 
-  vector<double> times;
+  ConstVecRef<double> times;
   retVal = getDoubleVec(DoubleFeatureData, StringData, "T", times);
   if (retVal < 0) return -1;
 
@@ -2529,57 +2509,30 @@ int LibV5::Spikecount_stimint(mapStr2intVec& IntFeatureData,
 }
 // end of Spikecount_stimint
 
-static int __peak_indices(double threshold, vector<double>& V,
-                          vector<double>& t, vector<int>& PeakIndex,
+static int __peak_indices(double threshold, const vector<double>& V,
+                          const vector<double>& t, vector<int>& PeakIndex,
                           bool strict_stiminterval, double stim_start,
                           double stim_end) {
-  vector<int> upVec, dnVec;
-  double dtmp;
-  int itmp;
-
-  for (unsigned i = 1; i < V.size(); i++) {
-    if (V[i] > threshold && V[i - 1] < threshold) {
-      upVec.push_back(i);
-    } else if (V[i] < threshold && V[i - 1] > threshold) {
-      dnVec.push_back(i);
-    }
-  }
-  if (dnVec.size() == 0) {
+  size_t upCrossings, downCrossings;
+  // up crossings without down crossing at the end of the trace give no peak
+  findThresholdPeaks(V, threshold, PeakIndex, upCrossings, downCrossings);
+  if (downCrossings == 0) {
     GErrorStr +=
         "\nVoltage never goes below or above threshold in spike detection.\n";
     return 0;
   }
 
-  if (upVec.size() > dnVec.size()) {
-    unsigned size_diff = upVec.size() - dnVec.size();
-    for (unsigned i = 0; i < size_diff; i++) {
-      upVec.pop_back();
-    }
-  }
-
-  PeakIndex.clear();
-  int j = 0;
-  for (unsigned i = 0; i < upVec.size(); i++) {
-    dtmp = -1e9;
-    itmp = -1;
-    EFEL_ASSERT(i < dnVec.size(), "dnVec array too small");
-    for (j = upVec[i]; j <= dnVec[i]; j++) {
-      if (dtmp < V[j]) {
-        dtmp = V[j];
-        itmp = j;
-      }
-    }
-    if (itmp != -1) {
-      if (strict_stiminterval) {
-        EFEL_ASSERT(itmp < t.size(), "peak_time falls outside of time array");
-        EFEL_ASSERT(itmp >= 0, "peak_time is negative");
-        if (t[itmp] >= stim_start && t[itmp] <= stim_end) {
-          PeakIndex.push_back(itmp);
-        }
-      } else {
-        PeakIndex.push_back(itmp);
+  if (strict_stiminterval) {
+    size_t nPeaks = 0;
+    for (size_t i = 0; i < PeakIndex.size(); i++) {
+      int itmp = PeakIndex[i];
+      EFEL_ASSERT(itmp < t.size(), "peak_time falls outside of time array");
+      EFEL_ASSERT(itmp >= 0, "peak_time is negative");
+      if (t[itmp] >= stim_start && t[itmp] <= stim_end) {
+        PeakIndex[nPeaks++] = itmp;
       }
     }
+    PeakIndex.resize(nPeaks);
   }
   return PeakIndex.size();
 }
@@ -2593,7 +2546,8 @@ int LibV5::peak_indices(mapStr2intVec& IntFeatureData,
   if (retVal) return nSize;
 
   vector<int> PeakIndex, strict_stiminterval_vec;
-  vector<double> v, t, threshold, stim_start_vec, stim_end_vec;
+  vector<double> threshold, stim_start_vec, stim_end_vec;
+  ConstVecRef<double> v, t;
   bool strict_stiminterval = false;
   double stim_start = 0.0, stim_end = 0.0;
 
@@ -2640,7 +2594,7 @@ int LibV5::peak_indices(mapStr2intVec& IntFeatureData,
                               strict_stiminterval, stim_start, stim_end);
 
   if (retval >= 0) {
-    setIntVec(IntFeatureData, StringData, "peak_indices", PeakIndex);
+    setIntVec(IntFeatureData, StringData, "peak_indices", std::move(PeakIndex));
   }
 
   return retval;
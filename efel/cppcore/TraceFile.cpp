@@ -0,0 +1,166 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TraceFile.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char traceFileMagic[8] = {'E', 'F', 'E', 'L', 'T', 'R', 'C', 0};
+
+MappedTraceFile::MappedTraceFile() : mapping(NULL), mappingSize(0), data(NULL) {
+  memset(&header, 0, sizeof(header));
+}
+
+MappedTraceFile::~MappedTraceFile() { close(); }
+
+void MappedTraceFile::close() {
+#ifndef _WIN32
+  if (mapping != NULL) munmap(mapping, mappingSize);
+#endif
+  mapping = NULL;
+  mappingSize = 0;
+  data = NULL;
+  memset(&header, 0, sizeof(header));
+}
+
+int MappedTraceFile::open(const string& path, string& error) {
+  close();
+#ifdef _WIN32
+  error = "Trace files can't be mapped on this platform";
+  return -1;
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error = "Can't open trace file " + path + ": " + strerror(errno);
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(TraceFileHeader)) {
+    ::close(fd);
+    error = "Trace file " + path + " is too short for its header";
+    return -1;
+  }
+  mappingSize = st.st_size;
+  mapping = mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    mapping = NULL;
+    mappingSize = 0;
+    error = "Can't map trace file " + path + ": " + strerror(errno);
+    return -1;
+  }
+  madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+  TraceFileHeader h;
+  memcpy(&h, mapping, sizeof(h));
+  const size_t columns = h.layout == TRACE_LAYOUT_V_ONLY ? 1 : 2;
+  const size_t sampleSize = h.dtype == 4 || h.dtype == 8 ? h.dtype : 1;
+  const size_t available =
+      (mappingSize - sizeof(TraceFileHeader)) / (columns * sampleSize);
+  if (memcmp(h.magic, traceFileMagic, sizeof(traceFileMagic)) != 0) {
+    error = path + " is not a trace file";
+  } else if (h.version != 1) {
+    error = "Unsupported version of trace file " + path;
+  } else if (h.dtype != 4 && h.dtype != 8) {
+    error = "Trace file " + path + " has an invalid sample size";
+  } else if (h.layout > TRACE_LAYOUT_V_ONLY) {
+    error = "Trace file " + path + " has an invalid layout";
+  } else if (h.n > available) {
+    error = "Trace file " + path + " is shorter than its sample count";
+  } else if (h.layout == TRACE_LAYOUT_V_ONLY && !(h.dt > 0)) {
+    error = "Trace file " + path + " needs a strictly positive dt";
+  } else {
+    header = h;
+    data = static_cast<const char*>(mapping) + sizeof(TraceFileHeader);
+    return 1;
+  }
+  close();
+  return -1;
+#endif
+}
+
+double MappedTraceFile::sample(size_t i) const {
+  if (header.dtype == 8) {
+    double value;
+    memcpy(&value, data + i * 8, 8);
+    return value;
+  }
+  float value;
+  memcpy(&value, data + i * 4, 4);
+  return value;
+}
+
+const double* MappedTraceFile::timeData() const {
+  if (header.dtype != 8 || header.layout != TRACE_LAYOUT_T_THEN_V) return NULL;
+  return reinterpret_cast<const double*>(data);
+}
+
+const double* MappedTraceFile::voltageData() const {
+  if (header.dtype != 8) return NULL;
+  if (header.layout == TRACE_LAYOUT_T_THEN_V) {
+    return reinterpret_cast<const double*>(data) + header.n;
+  }
+  if (header.layout == TRACE_LAYOUT_V_ONLY) {
+    return reinterpret_cast<const double*>(data);
+  }
+  return NULL;
+}
+
+void MappedTraceFile::readTime(vector<double>& t) const {
+  const size_t n = header.n;
+  t.resize(n);
+  switch (header.layout) {
+    case TRACE_LAYOUT_T_THEN_V:
+      for (size_t i = 0; i < n; i++) t[i] = sample(i);
+      break;
+    case TRACE_LAYOUT_INTERLEAVED:
+      for (size_t i = 0; i < n; i++) t[i] = sample(2 * i);
+      break;
+    case TRACE_LAYOUT_V_ONLY:
+      // multiplied rather than accumulated, so that rounding errors don't add
+      // up over long recordings
+      for (size_t i = 0; i < n; i++) t[i] = header.t0 + i * header.dt;
+      break;
+  }
+}
+
+void MappedTraceFile::readVoltage(vector<double>& v) const {
+  const size_t n = header.n;
+  v.resize(n);
+  switch (header.layout) {
+    case TRACE_LAYOUT_T_THEN_V:
+      for (size_t i = 0; i < n; i++) v[i] = sample(n + i);
+      break;
+    case TRACE_LAYOUT_INTERLEAVED:
+      for (size_t i = 0; i < n; i++) v[i] = sample(2 * i + 1);
+      break;
+    case TRACE_LAYOUT_V_ONLY:
+      for (size_t i = 0; i < n; i++) v[i] = sample(i);
+      break;
+  }
+}
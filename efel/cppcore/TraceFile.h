@@ -0,0 +1,100 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/*
+ * Binary trace file, all values in the byte order of the machine:
+ *
+ *   char     magic[8]   "EFELTRC\0"
+ *   uint32   version    1
+ *   uint32   dtype      bytes per sample, 8 (float64) or 4 (float32)
+ *   uint32   layout     one of TraceLayout
+ *   uint32   reserved   0
+ *   uint64   n          number of samples
+ *   float64  t0, dt     time of the first sample and the sampling step, only
+ *                       used by TRACE_LAYOUT_V_ONLY
+ *
+ * followed by the samples.
+ */
+enum TraceLayout {
+  // n times, then n voltages
+  TRACE_LAYOUT_T_THEN_V = 0,
+  // n (time, voltage) pairs
+  TRACE_LAYOUT_INTERLEAVED = 1,
+  // n voltages sampled every dt from t0
+  TRACE_LAYOUT_V_ONLY = 2
+};
+
+struct TraceFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t dtype;
+  uint32_t layout;
+  uint32_t reserved;
+  uint64_t n;
+  double t0;
+  double dt;
+};
+
+/*
+ * Read-only mapping of a trace file. The samples are paged in by the OS when
+ * they are read and are not copied to the heap, unless they have to be
+ * converted.
+ */
+class MappedTraceFile {
+ public:
+  MappedTraceFile();
+  ~MappedTraceFile();
+
+  // Returns -1 and fills error if the file can't be mapped or its header is
+  // invalid, 1 otherwise
+  int open(const string& path, string& error);
+  void close();
+
+  size_t size() const { return header.n; }
+  const TraceFileHeader& getHeader() const { return header; }
+  // The samples in the mapping if they are stored as consecutive float64,
+  // NULL otherwise
+  const double* timeData() const;
+  const double* voltageData() const;
+  // Copy of the samples, converted to double
+  void readTime(vector<double>& t) const;
+  void readVoltage(vector<double>& v) const;
+
+ private:
+  MappedTraceFile(const MappedTraceFile&);
+  MappedTraceFile& operator=(const MappedTraceFile&);
+
+  double sample(size_t i) const;
+
+  void* mapping;
+  size_t mappingSize;
+  const char* data;
+  TraceFileHeader header;
+};
+
+#endif
@@ -0,0 +1,183 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TraceGenerator.h"
+
+#include <algorithm>
+#include <math.h>
+
+static double getSetting(const mapStr2doubleVec& settings, const string& name,
+                         double defaultValue) {
+  mapStr2doubleVec::const_iterator it = settings.find(name);
+  return it != settings.end() && !it->second.empty() ? it->second[0]
+                                                      : defaultValue;
+}
+
+// splitmix64, a counter based generator gives every sample its own random
+// numbers regardless of the order in which the samples are generated
+static uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// uniform in (0, 1)
+static double uniform(uint64_t x) {
+  return ((mix(x) >> 11) + 0.5) * (1. / 9007199254740992.);
+}
+
+static const double pi = 3.14159265358979323846;
+
+// the spike shape is cut off where it is negligible
+static const double peakWindow = 6.;
+static const double ahpWindow = 15.;
+
+SyntheticTrace::SyntheticTrace()
+    : nSamples(0),
+      dt(0.),
+      stimStartTime(0.),
+      stimEndTime(0.),
+      vRest(0.),
+      stepAmplitude(0.),
+      tau(1.),
+      spikeAmplitude(0.),
+      spikeSigma(1.),
+      ahpDepth(0.),
+      ahpTau(1.),
+      noise(0.),
+      noiseKey(0) {}
+
+int SyntheticTrace::init(const mapStr2doubleVec& settings, string& error) {
+  const double duration = getSetting(settings, "duration", 1000.);
+  dt = getSetting(settings, "dt", 0.025);
+  stimStartTime = getSetting(settings, "stim_start", 100.);
+  stimEndTime = getSetting(settings, "stim_end", 900.);
+  vRest = getSetting(settings, "v_rest", -65.);
+  stepAmplitude = getSetting(settings, "step_amplitude", 10.);
+  tau = getSetting(settings, "tau", 10.);
+  const double rate = getSetting(settings, "spike_rate", 20.);
+  const double jitter = getSetting(settings, "spike_jitter", 0.);
+  spikeAmplitude = getSetting(settings, "spike_amplitude", 95.);
+  const double halfWidth = getSetting(settings, "spike_half_width", 0.5);
+  ahpDepth = getSetting(settings, "ahp_depth", 10.);
+  ahpTau = getSetting(settings, "ahp_tau", 3.);
+  noise = getSetting(settings, "noise", 0.);
+  const uint64_t seed =
+      static_cast<uint64_t>(getSetting(settings, "seed", 1.));
+
+  // spikes closer than this would not go back below the threshold
+  const double minISI = 3. * halfWidth;
+  if (!(duration >= 0.) || !(dt > 0.)) {
+    error = "duration can not be negative and dt has to be positive";
+  } else if (!(tau > 0.) || !(halfWidth > 0.) || !(ahpTau > 0.)) {
+    error = "tau, spike_half_width and ahp_tau have to be positive";
+  } else if (!(stimEndTime >= stimStartTime)) {
+    error = "stim_end can not be before stim_start";
+  } else if (!(rate >= 0.) || (rate > 0. && 1000. / rate < minISI)) {
+    error = "spike_rate has to be between 0 and 1000 / (3 spike_half_width)";
+  } else if (!(jitter >= 0. && jitter <= 1.)) {
+    error = "spike_jitter has to be between 0 and 1";
+  } else if (!(noise >= 0.)) {
+    error = "noise can not be negative";
+  } else {
+    error.clear();
+  }
+  if (!error.empty()) {
+    nSamples = 0;
+    spikes.clear();
+    return -1;
+  }
+
+  nSamples = static_cast<size_t>(floor(duration / dt)) + 1;
+  spikeSigma = halfWidth / (2. * sqrt(2. * log(2.)));
+  noiseKey = mix(seed);
+
+  // intervals of mean 1000 / rate ms, their random part is exponential
+  spikes.clear();
+  if (rate > 0.) {
+    const double meanISI = 1000. / rate;
+    const uint64_t spikeKey = mix(seed ^ 0x5851f42d4c957f2dULL);
+    double t = stimStartTime;
+    for (uint64_t i = 0;; i++) {
+      double isi = meanISI * (1. - jitter) -
+                   meanISI * jitter * log(uniform(spikeKey + i));
+      t += std::max(isi, minISI);
+      if (t >= stimEndTime) break;
+      spikes.push_back(t);
+    }
+  }
+  return 1;
+}
+
+double SyntheticTrace::stepResponse(double t) const {
+  if (t < stimStartTime) return 0.;
+  if (t < stimEndTime) {
+    return stepAmplitude * (1. - exp(-(t - stimStartTime) / tau));
+  }
+  return stepAmplitude * (1. - exp(-(stimEndTime - stimStartTime) / tau)) *
+         exp(-(t - stimEndTime) / tau);
+}
+
+// a gaussian peak, followed by an alpha function shaped AHP
+double SyntheticTrace::spikeShape(double t) const {
+  double v = 0.;
+  if (fabs(t) < peakWindow * spikeSigma) {
+    v += spikeAmplitude * exp(-t * t / (2. * spikeSigma * spikeSigma));
+  }
+  if (t > 0.) {
+    v -= ahpDepth * (t / ahpTau) * exp(1. - t / ahpTau);
+  }
+  return v;
+}
+
+double SyntheticTrace::noiseSample(size_t i) const {
+  if (noise == 0.) return 0.;
+  // Box-Muller
+  const double u1 = uniform(noiseKey + 2 * i);
+  const double u2 = uniform(noiseKey + 2 * i + 1);
+  return noise * sqrt(-2. * log(u1)) * cos(2. * pi * u2);
+}
+
+void SyntheticTrace::generate(size_t first, size_t count, vector<double>& t,
+                              vector<double>& v) const {
+  const size_t end =
+      first < nSamples ? first + std::min(count, nSamples - first) : first;
+  t.clear();
+  v.clear();
+  if (end <= first) return;
+  t.reserve(end - first);
+  v.reserve(end - first);
+
+  // the spikes that reach the first sample
+  vector<double>::const_iterator spike = std::lower_bound(
+      spikes.begin(), spikes.end(), first * dt - ahpWindow * ahpTau);
+  for (size_t i = first; i < end; i++) {
+    const double time = i * dt;
+    while (spike != spikes.end() && *spike + ahpWindow * ahpTau < time) {
+      ++spike;
+    }
+    double voltage = vRest + stepResponse(time) + noiseSample(i);
+    for (vector<double>::const_iterator s = spike;
+         s != spikes.end() && *s - peakWindow * spikeSigma < time; ++s) {
+      voltage += spikeShape(time - *s);
+    }
+    t.push_back(time);
+    v.push_back(voltage);
+  }
+}
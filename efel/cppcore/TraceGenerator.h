@@ -0,0 +1,83 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TRACEGENERATOR_H
+#define TRACEGENERATOR_H
+
+#include "types.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/*
+ * Deterministic synthetic voltage traces with known spike times, to measure
+ * how the feature extraction scales with the number of samples and spikes.
+ * The trace is a resting potential with a step response to a stimulus
+ * (a first order response with time constant tau that decays again after
+ * the stimulus), spikes during the stimulus with an afterhyperpolarization
+ * each, and gaussian noise. Every sample is computed from its index alone,
+ * so a long trace can be generated in chunks that are identical to the
+ * same samples of the whole trace. The same settings and seed give the same
+ * trace.
+ *
+ * Settings (like in FeatureStream), times in ms and voltages in mV:
+ *   duration (1000), dt (0.025), stim_start (100), stim_end (900),
+ *   v_rest (-65), step_amplitude (10), tau (10),
+ *   spike_rate in Hz (20), spike_jitter from 0 (regular) to 1 (Poisson, 0),
+ *   spike_amplitude (95), spike_half_width (0.5), ahp_depth (10),
+ *   ahp_tau (3), noise standard deviation (0), seed (1)
+ */
+class SyntheticTrace {
+ public:
+  SyntheticTrace();
+
+  // Returns -1 and fills error if a setting is out of range, 1 otherwise.
+  // The spike times are drawn here.
+  int init(const mapStr2doubleVec& settings, string& error);
+
+  // Number of samples of the whole trace
+  size_t size() const { return nSamples; }
+  double stimStart() const { return stimStartTime; }
+  double stimEnd() const { return stimEndTime; }
+  // The times of the spike peaks, ascending
+  const vector<double>& spikeTimes() const { return spikes; }
+
+  // Samples [first, first + count) of the trace, count is cut at size()
+  void generate(size_t first, size_t count, vector<double>& t,
+                vector<double>& v) const;
+
+ private:
+  double stepResponse(double t) const;
+  double spikeShape(double dt) const;
+  double noiseSample(size_t i) const;
+
+  size_t nSamples;
+  double dt;
+  double stimStartTime, stimEndTime;
+  double vRest, stepAmplitude, tau;
+  double spikeAmplitude, spikeSigma, ahpDepth, ahpTau;
+  double noise;
+  uint64_t noiseKey;
+  vector<double> spikes;
+};
+
+#endif
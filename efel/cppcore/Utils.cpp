@@ -18,6 +18,7 @@
 
 #include "Utils.h"
 #include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <iostream>
 #include <iostream>
@@ -25,98 +26,409 @@
 #include <math.h>
 #include <assert.h>
 
+/*
+ * Resample Y(X) at InterpX = X[0], X[0] + Stepdx, ... up to X.back() (the
+ * last value can be a partial step beyond X.back() and then gets Y.back()).
+ * The results are appended to InterpX and InterpY.
+ */
 int LinearInterpolation(double Stepdx,
                         const vector<double>& X,
                         const vector<double>& Y,
                         vector<double>& InterpX,
                         vector<double>& InterpY) {
   EFEL_ASSERT(X.size() == Y.size(), "X & Y have to have the same point count");
-  EFEL_ASSERT(2 < X.size(), "Need at least 2 points in X");
+  return LinearInterpolation(Stepdx, X.data(), Y.data(), X.size(), InterpX,
+                             InterpY);
+}
+
+// Slope of the segment [X[j], X[j+1]]
+static double segmentSlope(const double* X, const double* Y, size_t j) {
+  const double dx = X[j + 1] - X[j];
+  EFEL_ASSERT(dx != 0,  "Interpolation using dx == 0"); //!=0 per definition
+  return (Y[j + 1] - Y[j]) / dx;
+}
+
+int LinearInterpolation(double Stepdx, const double* X, const double* Y,
+                        size_t n, vector<double>& InterpX,
+                        vector<double>& InterpY) {
+  EFEL_ASSERT(2 < n, "Need at least 2 points in X");
   EFEL_ASSERT(Stepdx > 0, "Interpolation step needs to be strictly positive");
- 
-  double dx, dy, dydx;
-  int InterpX_size;
+
   double x = X[0];
   double start = X[0];
-  double stop = X[X.size() - 1] + Stepdx;
-  
+  double stop = X[n - 1] + Stepdx;
+
   // Inspired by the way numpy.arange works
   // Do not remove the 'ceil' in favor of < stop in for loop
-  InterpX_size = ceil((stop - start)/Stepdx);
+  const size_t InterpX_size = ceil((stop - start)/Stepdx);
+  InterpX.reserve(InterpX.size() + InterpX_size);
+  InterpY.reserve(InterpY.size() + InterpX_size);
 
-  for (unsigned i = 0; i < InterpX_size; i++) {
-      InterpX.push_back(x);
-      x += Stepdx;
+  // The points are accumulated rather than computed as start + i * Stepdx,
+  // to get exactly the same time points as always
+  for (size_t i = 0; i < InterpX_size; i++) {
+    InterpX.push_back(x);
+    x += Stepdx;
   }
 
-  // Create the y values
-  unsigned j = 0;
-  for (unsigned i = 0; i < InterpX.size(); i++) {
-    x = InterpX[i];
+  // Create the y values, walking X and InterpX in merge order. j is the
+  // first segment [X[j], X[j+1]] that ends at or after x. A point beyond
+  // the last segment gets Y.back() and ends the interpolation. The slope of
+  // a segment is computed, and checked, once when the walk reaches it.
+  const double* interpX = &InterpX[InterpX.size() - InterpX_size];
+  size_t j = 0;
+  double dydx = segmentSlope(X, Y, j);
+  for (size_t i = 0; i < InterpX_size; i++) {
+    x = interpX[i];
+    if (X[j + 1] < x) {
+      while (X[j + 1] < x) {
+        if (++j == n - 1) break;
+      }
+      if (j == n - 1) {
+        // Last point
+        InterpY.push_back(Y[j]);
+        break;
+      }
+      dydx = segmentSlope(X, Y, j);
+    }
+    InterpY.push_back(Y[j] + dydx * (x - X[j]));
+  }
 
-    EFEL_ASSERT((j+1) < X.size(), "Interpolation accessing point outside of X");
-    
-    while ( X[j+1] < x ) {
-        j++;
-        if (j+1 >= X.size()) {
-            j = X.size() - 1;
-            break;
-        }
-        EFEL_ASSERT((j+1) < X.size(), 
-                "Interpolation accessing point outside of X");
+  return 1;
+}
+
+/*
+ * True if X consists of exactly the points LinearInterpolation(dt, X, ...)
+ * would produce, as for simulator output recorded at a step of dt.
+ * Interpolating would then only make a copy of the trace.
+ * The points have to match exactly, features compare them with the
+ * stimulus times, so any rounding difference can change the results.
+ */
+bool isInterpolationGrid(double dt, const vector<double>& X) {
+  return isInterpolationGrid(dt, X.data(), X.size());
+}
+
+bool isInterpolationGrid(double dt, const double* X, size_t n) {
+  if (n < 2 || !(dt > 0)) return false;
+  if (static_cast<size_t>(ceil((X[n - 1] + dt - X[0]) / dt)) != n) {
+    return false;
+  }
+  double x = X[0];
+  for (size_t i = 0; i < n; i++) {
+    if (X[i] != x) return false;
+    x += dt;
+  }
+  return true;
+}
+
+// First i in [begin, t.size()) for which before(t[i], time) is false. On a
+// uniform grid the index is guessed from the sampling step, the guess is
+// only taken if its neighbours confirm it.
+template <class Before>
+static size_t searchTimeIndex(const vector<double>& t, double time,
+                              size_t begin, Before before) {
+  const size_t end = t.size();
+  if (begin >= end || std::isnan(time)) return end;
+  if (end - begin >= 2) {
+    const double dt = (t[end - 1] - t[begin]) / (end - 1 - begin);
+    const double steps = ceil((time - t[begin]) / dt);
+    size_t i = end;
+    if (!(steps > 0)) {
+      i = begin;
+    } else if (steps < end - begin) {
+      i = begin + static_cast<size_t>(steps);
+    }
+    if (i < end && before(t[i], time)) i++;
+    if (i > begin && !before(t[i - 1], time)) i--;
+    if ((i == begin || before(t[i - 1], time)) &&
+        (i == end || !before(t[i], time))) {
+      return i;
     }
-    
+  }
+  return std::partition_point(t.begin() + begin, t.end(),
+                              [&](double ti) { return before(ti, time); }) -
+         t.begin();
+}
 
+size_t findTimeIndex(const vector<double>& t, double time, size_t begin) {
+  return searchTimeIndex(t, time, begin,
+                         [](double ti, double x) { return ti < x; });
+}
 
-    if (j == X.size() - 1) {
-        // Last point
-        InterpY.push_back(Y[j]);
-        break;
-    } 
-    else {
-        EFEL_ASSERT((j+1) < X.size(), 
-                "Interpolation accessing point outside of X");
-        
-        dx = X[j+1] - X[j];
-        dy = Y[j+1] - Y[j];
+size_t findTimeIndexAfter(const vector<double>& t, double time,
+                          size_t begin) {
+  return searchTimeIndex(t, time, begin,
+                         [](double ti, double x) { return ti <= x; });
+}
+
+static inline bool isThresholdCrossing(const vector<double>& V,
+                                       double threshold, size_t i) {
+  return (V[i] > threshold && V[i - 1] < threshold) ||
+         (V[i] < threshold && V[i - 1] > threshold);
+}
 
-        EFEL_ASSERT(dx != 0,  "Interpolation using dx == 0"); //!=0 per definition
+// Index of the first threshold crossing at or after i, or V.size() if there
+// is none. Blocks of samples that all lie on the same side of the threshold
+// are skipped, their min and max are computed branch free so the compiler
+// can vectorise it.
+static size_t nextThresholdCrossing(const vector<double>& V, double threshold,
+                                    size_t i) {
+  const size_t block = 16;
+  const size_t n = V.size();
+  for (; i + block <= n; i += block) {
+    double lowest = V[i - 1];
+    double highest = V[i - 1];
+    for (size_t k = i; k < i + block; k++) {
+      lowest = V[k] < lowest ? V[k] : lowest;
+      highest = V[k] > highest ? V[k] : highest;
+    }
+    if (lowest > threshold || highest < threshold) continue;
+    for (size_t k = i; k < i + block; k++) {
+      if (isThresholdCrossing(V, threshold, k)) return k;
+    }
+  }
+  for (; i < n; i++) {
+    if (isThresholdCrossing(V, threshold, i)) break;
+  }
+  return i;
+}
 
-        dydx = dy/dx;
+/*
+ * Spike detection by threshold crossing, shared by the peak_indices of the
+ * libraries. An up crossing is a sample above threshold preceded by one below
+ * it, a down crossing the other way round. The n-th up crossing is paired
+ * with the n-th down crossing, and the index of the first maximum of V from
+ * the up to the down crossing (both included) is appended to PeakIndex.
+ * Pairs whose down crossing comes first (trace starting above threshold)
+ * give no peak, nor do up crossings without a down crossing.
+ * This is done in a single pass over V, the counts of crossings are returned
+ * in upCrossings and downCrossings for the libraries to check the trace
+ * shape. Returns the number of peaks found.
+ */
+int findThresholdPeaks(const vector<double>& V, double threshold,
+                       vector<int>& PeakIndex, size_t& upCrossings,
+                       size_t& downCrossings) {
+  PeakIndex.clear();
+  upCrossings = 0;
+  downCrossings = 0;
+
+  // the oldest up crossing still waiting for its down crossing
+  bool inSpike = false;
+  size_t spikeStart = 0;
+  double spikeMax = 0.;
+  int spikeMaxIndex = -1;
+  // later up crossings waiting as well, only when V touched the threshold
+  // exactly in between
+  vector<size_t> queuedStarts;
+  size_t queuedHead = 0;
+  // down crossings whose up crossing has not been seen yet
+  size_t unpairedDowns = 0;
 
-        InterpY.push_back(Y[j] + dydx * (x - X[j]));
+  const size_t n = V.size();
+  for (size_t i = 1; i < n; i++) {
+    if (!inSpike) {
+      i = nextThresholdCrossing(V, threshold, i);
+      if (i == n) break;
+    }
+    const bool up = V[i] > threshold && V[i - 1] < threshold;
+    const bool down = V[i] < threshold && V[i - 1] > threshold;
+
+    if (up) {
+      upCrossings++;
+      if (unpairedDowns > 0) {
+        unpairedDowns--;
+      } else if (!inSpike) {
+        inSpike = true;
+        spikeStart = i;
+        spikeMax = -1e9;
+        spikeMaxIndex = -1;
+      } else {
+        queuedStarts.push_back(i);
+      }
+    }
+    if (inSpike && spikeMax < V[i]) {
+      spikeMax = V[i];
+      spikeMaxIndex = i;
+    }
+    if (down) {
+      downCrossings++;
+      if (!inSpike) {
+        unpairedDowns++;
+        continue;
+      }
+      if (spikeMaxIndex != -1) PeakIndex.push_back(spikeMaxIndex);
+      inSpike = queuedHead < queuedStarts.size();
+      if (inSpike) {
+        spikeStart = queuedStarts[queuedHead++];
+        spikeMax = -1e9;
+        spikeMaxIndex = -1;
+        for (size_t j = spikeStart; j <= i; j++) {
+          if (spikeMax < V[j]) {
+            spikeMax = V[j];
+            spikeMaxIndex = j;
+          }
+        }
+      }
     }
   }
+  return PeakIndex.size();
+}
 
-  return 1;
+/*
+ * The derivatives below are computed in loops over the inner points. On x86
+ * builds with gcc or clang these loops have an AVX2 version as well, which is
+ * used when the CPU supports it. Both versions do exactly the same
+ * operations in the same order, so they give identical results.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EFEL_AVX2_DISPATCH
+#include <immintrin.h>
+
+static bool cpuHasAVX2() {
+  static const bool avx2 = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return avx2;
+}
+#endif
+
+// dv[i] = ((v[i + 1] - v[i - 1]) / 2) / dx for i in [begin, end)
+static void centralDifference(const double* v, double dx, double* dv,
+                              size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    dv[i] = ((v[i + 1] - v[i - 1]) / 2) / dx;
+  }
+}
+
+// dvdt[i] = ((v[i + 1] - v[i - 1]) / 2) / ((t[i + 1] - t[i - 1]) / 2)
+static void centralDifferenceRatio(const double* v, const double* t,
+                                   double* dvdt, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    dvdt[i] = ((v[i + 1] - v[i - 1]) / 2) / ((t[i + 1] - t[i - 1]) / 2);
+  }
 }
 
+// dv[i] = (-v[i + 2] + 8 * v[i + 1] - 8 * v[i - 1] + v[i - 2]) / 12
+static void fivePointStencil(const double* v, double* dv, size_t begin,
+                             size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    dv[i] = (-v[i + 2] + 8 * v[i + 1] - 8 * v[i - 1] + v[i - 2]) / 12.;
+  }
+}
+
+#ifdef EFEL_AVX2_DISPATCH
+__attribute__((target("avx2"))) static void centralDifferenceAVX2(
+    const double* v, double dx, double* dv, size_t begin, size_t end) {
+  const __m256d two = _mm256_set1_pd(2.);
+  const __m256d vdx = _mm256_set1_pd(dx);
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m256d diff =
+        _mm256_sub_pd(_mm256_loadu_pd(v + i + 1), _mm256_loadu_pd(v + i - 1));
+    _mm256_storeu_pd(dv + i, _mm256_div_pd(_mm256_div_pd(diff, two), vdx));
+  }
+  // the scalar code after this (e.g. libm) would otherwise pay for every
+  // switch from the dirty upper AVX state
+  _mm256_zeroupper();
+  centralDifference(v, dx, dv, i, end);
+}
+
+__attribute__((target("avx2"))) static void centralDifferenceRatioAVX2(
+    const double* v, const double* t, double* dvdt, size_t begin,
+    size_t end) {
+  const __m256d two = _mm256_set1_pd(2.);
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m256d dv = _mm256_div_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(v + i + 1), _mm256_loadu_pd(v + i - 1)),
+        two);
+    __m256d dt = _mm256_div_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(t + i + 1), _mm256_loadu_pd(t + i - 1)),
+        two);
+    _mm256_storeu_pd(dvdt + i, _mm256_div_pd(dv, dt));
+  }
+  _mm256_zeroupper();
+  centralDifferenceRatio(v, t, dvdt, i, end);
+}
+
+__attribute__((target("avx2"))) static void fivePointStencilAVX2(
+    const double* v, double* dv, size_t begin, size_t end) {
+  // flipping the sign bit is exactly the unary minus
+  const __m256d sign = _mm256_set1_pd(-0.);
+  const __m256d eight = _mm256_set1_pd(8.);
+  const __m256d twelve = _mm256_set1_pd(12.);
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m256d sum = _mm256_xor_pd(_mm256_loadu_pd(v + i + 2), sign);
+    sum = _mm256_add_pd(sum,
+                        _mm256_mul_pd(eight, _mm256_loadu_pd(v + i + 1)));
+    sum = _mm256_sub_pd(sum,
+                        _mm256_mul_pd(eight, _mm256_loadu_pd(v + i - 1)));
+    sum = _mm256_add_pd(sum, _mm256_loadu_pd(v + i - 2));
+    _mm256_storeu_pd(dv + i, _mm256_div_pd(sum, twelve));
+  }
+  _mm256_zeroupper();
+  fivePointStencil(v, dv, i, end);
+}
+#endif
+
 int getCentralDifferenceDerivative(double dx, const vector<double>& v,
                                    vector<double>& dv) {
-  unsigned n = v.size();
-  dv.clear();
+  const size_t n = v.size();
+  dv.resize(n);
   // because formula is ((vec[i+1]+vec[i-1])/2)/dx hence it should iterate
   // through 1 to length-1
-  dv.push_back((v[1] - v[0]) / dx);
-  for (unsigned i = 1; i < n - 1; i++) {
-    dv.push_back(((v[i + 1] - v[i - 1]) / 2) / dx);
-  }
-  dv.push_back((v[n - 1] - v[n - 2]) / dx);
+  dv[0] = (v[1] - v[0]) / dx;
+#ifdef EFEL_AVX2_DISPATCH
+  if (cpuHasAVX2()) {
+    centralDifferenceAVX2(&v[0], dx, &dv[0], 1, n - 1);
+  } else
+#endif
+  centralDifference(&v[0], dx, &dv[0], 1, n - 1);
+  dv[n - 1] = (v[n - 1] - v[n - 2]) / dx;
+  return 1;
+}
+
+// The last difference of the shorter vector is one-sided, as in
+// getCentralDifferenceDerivative, the longer one still has a central
+// difference there
+static double lastDifference(const vector<double>& x, size_t n) {
+  if (x.size() == n) return x[n - 1] - x[n - 2];
+  return (x[n] - x[n - 2]) / 2;
+}
+
+int getCentralDifferenceDvdt(const vector<double>& v, const vector<double>& t,
+                             vector<double>& dvdt) {
+  const size_t n = std::min(v.size(), t.size());
+  dvdt.resize(n);
+  dvdt[0] = (v[1] - v[0]) / (t[1] - t[0]);
+#ifdef EFEL_AVX2_DISPATCH
+  if (cpuHasAVX2()) {
+    centralDifferenceRatioAVX2(&v[0], &t[0], &dvdt[0], 1, n - 1);
+  } else
+#endif
+  centralDifferenceRatio(&v[0], &t[0], &dvdt[0], 1, n - 1);
+  dvdt[n - 1] = lastDifference(v, n) / lastDifference(t, n);
   return 1;
 }
 
 void getfivepointstencilderivative(const vector<double>& v,
                                    vector<double>& dv) {
-  dv.clear();
-  dv.resize(v.size());
+  const size_t n = v.size();
+  dv.resize(n);
   dv[0] = v[1] - v[0];
   dv[1] = (v[2] - v[0]) / 2.;
-  for (unsigned i = 2; i < v.size() - 2; i++) {
-    dv[i] = -v[i + 2] + 8 * v[i + 1] - 8 * v[i - 1] + v[i - 2];
-    dv[i] /= 12.;
+  if (n > 4) {
+#ifdef EFEL_AVX2_DISPATCH
+    if (cpuHasAVX2()) {
+      fivePointStencilAVX2(&v[0], &dv[0], 2, n - 2);
+    } else
+#endif
+    fivePointStencil(&v[0], &dv[0], 2, n - 2);
   }
-  dv[v.size() - 2] = (v[v.size() - 1] - v[v.size() - 3]) / 2.;
-  dv[v.size() - 1] = v[v.size() - 1] - v[v.size() - 2];
+  dv[n - 2] = (v[n - 1] - v[n - 3]) / 2.;
+  dv[n - 1] = v[n - 1] - v[n - 2];
 }
 
 // fit a straight line to the points (x[i], y[i]) and return the slope y'(x)
@@ -164,3 +476,38 @@ slope_straight_line_fit(const vector<double>& x,
 
   return result;
 }
+
+LogLinearFit::LogLinearFit(const double* x, const double* y, size_t n)
+    : x(x), y(y), n(n), sum_x(0.), sum_x2(0.), log_y(n) {
+  EFEL_ASSERT(1 <= n, "Need at least 1 points in X");
+  for (size_t i = 0; i < n; i++) {
+    sum_x += x[i];
+    sum_x2 += x[i] * x[i];
+  }
+}
+
+linear_fit_result LogLinearFit::fit(double offset, bool residuals) {
+  double sum_y = 0.;
+  double sum_xy = 0.;
+  for (size_t i = 0; i < n; i++) {
+    log_y[i] = log(y[i] + offset);
+    sum_y += log_y[i];
+    sum_xy += x[i] * log_y[i];
+  }
+
+  linear_fit_result result;
+  double delta = n * sum_x2 - sum_x * sum_x;
+  result.slope = (n * sum_xy - sum_x * sum_y) / delta;
+  result.average_rss = 0.;
+  result.r_square = NAN;
+  if (residuals) {
+    double yintercept = (sum_y - result.slope * sum_x) / n;
+    double rss = 0.;
+    for (size_t i = 0; i < n; i++) {
+      double res = log_y[i] - yintercept - result.slope * x[i];
+      rss += res * res;
+    }
+    result.average_rss = rss / n;
+  }
+  return result;
+}
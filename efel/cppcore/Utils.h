@@ -39,12 +39,56 @@ struct linear_fit_result
 int LinearInterpolation(double dt, const vector<double>& X,
                         const vector<double>& Y, vector<double>& InterpX,
                         vector<double>& InterpY);
+// The same on the n points of X and Y
+int LinearInterpolation(double dt, const double* X, const double* Y, size_t n,
+                        vector<double>& InterpX, vector<double>& InterpY);
+bool isInterpolationGrid(double dt, const vector<double>& X);
+bool isInterpolationGrid(double dt, const double* X, size_t n);
+// Index of the first t[i] >= time (findTimeIndex) or t[i] > time
+// (findTimeIndexAfter) with i >= begin, t.size() if there is none. t has to
+// be sorted ascending, as the time of a trace is. The index is computed
+// directly for uniformly sampled t and binary searched otherwise.
+size_t findTimeIndex(const vector<double>& t, double time, size_t begin = 0);
+size_t findTimeIndexAfter(const vector<double>& t, double time,
+                          size_t begin = 0);
+int findThresholdPeaks(const vector<double>& V, double threshold,
+                       vector<int>& PeakIndex, size_t& upCrossings,
+                       size_t& downCrossings);
 int getCentralDifferenceDerivative(double dx, const vector<double>& v,
                                    vector<double>& dv);
+// dV/dt by central differences of v and t, as the ratio of the
+// getCentralDifferenceDerivative of both but in a single pass. It has the
+// size of the shorter of v and t (interpolated traces have one V less than T)
+// which needs at least 2 points.
+int getCentralDifferenceDvdt(const vector<double>& v, const vector<double>& t,
+                             vector<double>& dvdt);
 void getfivepointstencilderivative(const vector<double>& v, vector<double>& dv);
 linear_fit_result slope_straight_line_fit(const vector<double>& x,
                                           const vector<double>& y);
 
+/*
+ * Straight line fits of log(y[i] + offset) over x[i], as used to fit an
+ * exponential decay to (x, y) with an unknown asymptote offset. The sums
+ * over x are computed once, every fit then takes a pass computing the logs
+ * and their sums and one for the residuals (skipped if residuals is false).
+ * The slope and average_rss are the same as those of slope_straight_line_fit
+ * on the logs, r_square is not computed.
+ * x and y have to stay valid for the lifetime of the object.
+ */
+class LogLinearFit {
+ public:
+  LogLinearFit(const double* x, const double* y, size_t n);
+  linear_fit_result fit(double offset, bool residuals = true);
+
+ private:
+  const double* x;
+  const double* y;
+  size_t n;
+  double sum_x;
+  double sum_x2;
+  vector<double> log_y;
+};
+
 template <class ForwardIterator>
 ForwardIterator first_min_element(ForwardIterator first, ForwardIterator last) {
   ForwardIterator lowest = first;
@@ -0,0 +1,126 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Measures the throughput of the derivatives in Utils.cpp and checks that
+ * they give exactly the same results as the previous implementations, which
+ * are kept here as a reference. The dV/dt used to be computed as two
+ * central difference derivatives and their ratio.
+ */
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <math.h>
+
+static int oldCentralDifferenceDerivative(double dx, const vector<double>& v,
+                                          vector<double>& dv) {
+  unsigned n = v.size();
+  dv.clear();
+  dv.push_back((v[1] - v[0]) / dx);
+  for (unsigned i = 1; i < n - 1; i++) {
+    dv.push_back(((v[i + 1] - v[i - 1]) / 2) / dx);
+  }
+  dv.push_back((v[n - 1] - v[n - 2]) / dx);
+  return 1;
+}
+
+static void oldFivePointStencilDerivative(const vector<double>& v,
+                                          vector<double>& dv) {
+  dv.clear();
+  dv.resize(v.size());
+  dv[0] = v[1] - v[0];
+  dv[1] = (v[2] - v[0]) / 2.;
+  for (unsigned i = 2; i < v.size() - 2; i++) {
+    dv[i] = -v[i + 2] + 8 * v[i + 1] - 8 * v[i - 1] + v[i - 2];
+    dv[i] /= 12.;
+  }
+  dv[v.size() - 2] = (v[v.size() - 1] - v[v.size() - 3]) / 2.;
+  dv[v.size() - 1] = v[v.size() - 1] - v[v.size() - 2];
+}
+
+static void oldDvdt(const vector<double>& v, const vector<double>& t,
+                    vector<double>& dvdt) {
+  vector<double> dv, dt;
+  dvdt.resize(v.size());
+  oldCentralDifferenceDerivative(1., v, dv);
+  oldCentralDifferenceDerivative(1., t, dt);
+  std::transform(dv.begin(), dv.end(), dt.begin(), dvdt.begin(),
+                 std::divides<double>());
+}
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds(bench_clock::time_point start) {
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+static void report(const char* name, size_t n, double old_s, double new_s,
+                   const vector<double>& old_result,
+                   const vector<double>& new_result) {
+  printf("%s: %d samples\n", name, (int)n);
+  printf("  previous implementation: %8.1f Msamples/s\n", n / old_s / 1e6);
+  printf("  current implementation:  %8.1f Msamples/s\n", n / new_s / 1e6);
+  if (old_result != new_result) {
+    printf("  RESULTS DIFFER\n");
+    exit(1);
+  }
+}
+
+int main(int argc, char** argv) {
+  const size_t n = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  vector<double> t(n), v(n);
+  double time = 0.;
+  for (size_t i = 0; i < n; i++) {
+    t[i] = time;
+    v[i] = -65. + 40. * sin(i * 0.001) * sin(i * 0.0173);
+    time += 0.025 + 0.001 * (i % 3);
+  }
+
+  // allocated up front, so that only the computation is timed
+  vector<double> old_result(n), new_result(n);
+  bench_clock::time_point start = bench_clock::now();
+  oldCentralDifferenceDerivative(0.025, v, old_result);
+  double old_s = seconds(start);
+  start = bench_clock::now();
+  getCentralDifferenceDerivative(0.025, v, new_result);
+  report("central difference", n, old_s, seconds(start), old_result,
+         new_result);
+
+  start = bench_clock::now();
+  oldFivePointStencilDerivative(v, old_result);
+  old_s = seconds(start);
+  start = bench_clock::now();
+  getfivepointstencilderivative(v, new_result);
+  report("five point stencil", n, old_s, seconds(start), old_result,
+         new_result);
+
+  start = bench_clock::now();
+  oldDvdt(v, t, old_result);
+  old_s = seconds(start);
+  start = bench_clock::now();
+  getCentralDifferenceDvdt(v, t, new_result);
+  report("dV/dt", n, old_s, seconds(start), old_result, new_result);
+
+  return 0;
+}
@@ -0,0 +1,585 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Benchmark of every feature kernel registered by FillFptrTable, of
+ * LinearInterpolation, of the derivatives in Utils and of the dependency
+ * file loader, on the traces of tests/testdata/basic and synthetic traces
+ * (see TraceGenerator.h), and on longer versions of them: the test traces are
+ * repeated in time, the synthetic traces get a longer duration and stimulus.
+ * It prints one tab separated line per benchmark, meant to be diffed between
+ * releases:
+ *
+ *   trace scale samples benchmark status ns ns_per_sample allocations bytes
+ *
+ * samples is the size of the trace after the interpolation, ns is the best
+ * time of the repetitions, allocations and bytes are the calls of operator
+ * new and the memory they requested in one run. A kernel runs on the data of
+ * a trace on which its dependencies from the dependency file have been
+ * calculated, as cFeature would run it. A kernel that the dependency file
+ * doesn't use runs after the dependencies of the kernel it uses for the same
+ * feature, a feature that isn't in the dependency file is listed once with
+ * the status "not_in_dependency_file". The steps with wildcards run on copies
+ * of the trace for every stimulus and location that the features select, see
+ * wildcardTraces. "failed" means that the kernel returned an error on that
+ * trace, most often because it has no spikes or not the ones it needs.
+ *
+ * Usage: efel_bench [-d dependency_file] [-r repetitions] [-s scale]...
+ *                   [-f name_filter] [-g spike_rate_hz:sampling_khz]...
+ *                   [trace_file:stim_start:stim_end]...
+ */
+
+#include "DependencyTree.h"
+#include "FillFptrTable.h"
+#include "TraceGenerator.h"
+#include "Utils.h"
+#include "mapoperations.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef EFEL_DIR
+#define EFEL_DIR "."
+#endif
+
+static size_t allocationCount = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size) {
+  allocationCount++;
+  allocatedBytes += size;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+
+struct Measurement {
+  double seconds;
+  size_t allocations;
+  size_t bytes;
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+template <typename Function>
+static Measurement measure(Function function) {
+  Measurement measurement;
+  const size_t allocations = allocationCount;
+  const size_t bytes = allocatedBytes;
+  bench_clock::time_point start = bench_clock::now();
+  function();
+  measurement.seconds =
+      std::chrono::duration<double>(bench_clock::now() - start).count();
+  measurement.allocations = allocationCount - allocations;
+  measurement.bytes = allocatedBytes - bytes;
+  return measurement;
+}
+
+static void keepBest(Measurement& best, const Measurement& measurement,
+                     unsigned repetition) {
+  if (repetition == 0 || measurement.seconds < best.seconds) {
+    best = measurement;
+  }
+}
+
+struct Trace {
+  string name;
+  int scale;
+  vector<double> t, v;
+  double stimStart, stimEnd;
+  // the settings of a synthetic trace, empty for a trace from a file
+  mapStr2doubleVec synthetic;
+};
+
+static void report(const Trace& trace, size_t samples, const string& name,
+                   const char* status, const Measurement& measurement) {
+  const double ns = measurement.seconds * 1e9;
+  printf("%s\t%d\t%d\t%s\t%s\t%.0f\t", trace.name.c_str(), trace.scale,
+         (int)samples, name.c_str(), status, ns);
+  if (samples > 0) {
+    printf("%.3f", ns / samples);
+  } else {
+    printf("-");
+  }
+  printf("\t%d\t%d\n", (int)measurement.allocations, (int)measurement.bytes);
+  // keep what was measured if a kernel crashes
+  fflush(stdout);
+}
+
+// for the benchmarks that don't depend on a trace
+static const Trace& noTrace() {
+  static Trace none;
+  none.name = "-";
+  none.scale = 0;
+  return none;
+}
+
+static bool loadTrace(const string& path, Trace& trace) {
+  FILE* fp = fopen(path.c_str(), "r");
+  if (fp == NULL) return false;
+  double t, v;
+  while (fscanf(fp, "%lf %lf", &t, &v) == 2) {
+    trace.t.push_back(t);
+    trace.v.push_back(v);
+  }
+  fclose(fp);
+  size_t slash = path.find_last_of('/');
+  trace.name = slash == string::npos ? path : path.substr(slash + 1);
+  trace.scale = 1;
+  return trace.t.size() > 2;
+}
+
+static Trace syntheticTrace(const Trace& trace, int scale) {
+  Trace scaled(trace);
+  scaled.scale = scale;
+  mapStr2doubleVec settings(trace.synthetic);
+  const double duration = settings["duration"][0];
+  settings["duration"][0] = duration * scale;
+  settings["stim_end"][0] += (scale - 1) * duration;
+
+  SyntheticTrace generator;
+  string error;
+  if (generator.init(settings, error) < 0) {
+    fprintf(stderr, "Can't generate %s: %s\n", trace.name.c_str(),
+            error.c_str());
+    exit(1);
+  }
+  generator.generate(0, generator.size(), scaled.t, scaled.v);
+  scaled.stimStart = generator.stimStart();
+  scaled.stimEnd = generator.stimEnd();
+  return scaled;
+}
+
+// The trace repeated scale times, the stimulus lasts until the same time
+// before the end of the last repetition
+static Trace scaleTrace(const Trace& trace, int scale) {
+  if (!trace.synthetic.empty()) return syntheticTrace(trace, scale);
+  Trace scaled(trace);
+  scaled.scale = scale;
+  const size_t n = trace.t.size();
+  const double period =
+      trace.t[n - 1] - trace.t[0] + (trace.t[n - 1] - trace.t[n - 2]);
+  for (int i = 1; i < scale; i++) {
+    for (size_t j = 0; j < n; j++) {
+      scaled.t.push_back(trace.t[j] + i * period);
+      scaled.v.push_back(trace.v[j]);
+    }
+  }
+  scaled.stimEnd += (scale - 1) * period;
+  return scaled;
+}
+
+// The default settings of efel.api
+static void setDefaultSettings(mapStr2intVec& intData,
+                               mapStr2doubleVec& doubleData) {
+  doubleData["spike_skipf"] = vector<double>(1, 0.1);
+  intData["max_spike_skip"] = vector<int>(1, 2);
+  doubleData["Threshold"] = vector<double>(1, -20.);
+  doubleData["DerivativeThreshold"] = vector<double>(1, 10.);
+  doubleData["interp_step"] = vector<double>(1, 0.1);
+  doubleData["burst_factor"] = vector<double>(1, 1.5);
+  doubleData["voltage_base_start_perc"] = vector<double>(1, 0.9);
+  doubleData["voltage_base_end_perc"] = vector<double>(1, 1.0);
+  doubleData["initial_perc"] = vector<double>(1, 0.1);
+  doubleData["min_spike_height"] = vector<double>(1, 20.);
+  intData["strict_stiminterval"] = vector<int>(1, 0);
+  doubleData["initburst_freq_threshold"] = vector<double>(1, 50.);
+  doubleData["initburst_sahp_start"] = vector<double>(1, 5.);
+  doubleData["initburst_sahp_end"] = vector<double>(1, 100.);
+  intData["DerivativeWindow"] = vector<int>(1, 3);
+  doubleData["decay_start_after_stim"] = vector<double>(1, 1.);
+  doubleData["decay_end_after_stim"] = vector<double>(1, 10.);
+}
+
+// The settings without a default that some features need, with the values of
+// the tests
+static void setFeatureSettings(mapStr2doubleVec& doubleData) {
+  doubleData["stimulus_current"] = vector<double>(1, 1.);
+  doubleData["AP_phaseslope_range"] = vector<double>(1, 2.);
+}
+
+struct TraceData {
+  mapStr2intVec intData;
+  mapStr2doubleVec doubleData;
+  mapStr2Str strData;
+};
+
+// A kernel and the plan steps that calculate its dependencies, status is
+// empty if it can be run
+struct Kernel {
+  string name;
+  feature_function function;
+  vector<unsigned> dependencies;
+  // if the dependencies run on the traces of the wildcard trace set
+  bool wildcards;
+  const char* status;
+};
+
+// The kernels of the dependency file run after the steps of their feature.
+// The other kernels of FillFptrTable replace the one of the dependency file
+// for the same feature and run after its dependencies.
+static void findKernels(const ExecutionPlan& plan,
+                        const std::map<string, feature2function*>& libs,
+                        vector<Kernel>& kernels) {
+  for (std::map<string, feature2function*>::const_iterator lib =
+           libs.begin();
+       lib != libs.end(); ++lib) {
+    for (feature2function::const_iterator it = lib->second->begin();
+         it != lib->second->end(); ++it) {
+      Kernel kernel;
+      kernel.name = lib->first + ":" + it->first;
+      kernel.function = it->second;
+      kernel.wildcards = false;
+      kernel.status = NULL;
+      std::map<string, vector<unsigned> >::const_iterator feature =
+          plan.featureSteps.find(it->first);
+      if (feature == plan.featureSteps.end()) {
+        kernel.status = "not_in_dependency_file";
+      } else {
+        const vector<unsigned>& steps = feature->second;
+        kernel.dependencies.assign(steps.begin(), steps.end() - 1);
+        for (size_t i = 0; i < steps.size(); i++) {
+          if (!plan.steps[steps[i]].second.empty()) kernel.wildcards = true;
+        }
+      }
+      kernels.push_back(kernel);
+    }
+  }
+}
+
+// Runs the steps as cFeature::runStep does: a step with wildcards runs once
+// on every trace that matches them
+static void runSteps(const ExecutionPlan& plan, const vector<unsigned>& steps,
+                     TraceData& data) {
+  for (size_t i = 0; i < steps.size(); i++) {
+    const featureStringPair& step = plan.steps[steps[i]];
+    if (step.second.empty()) {
+      step.first(data.intData, data.doubleData, data.strData);
+      continue;
+    }
+    vector<string> params;
+    getTraces(data.doubleData, step.second, params);
+    for (size_t j = 0; j < params.size(); j++) {
+      data.strData["params"] = params[j];
+      step.first(data.intData, data.doubleData, data.strData);
+    }
+    data.strData["params"] = "";
+  }
+}
+
+struct WildcardTrace {
+  const char* params;
+  double stimulusCurrent;
+};
+
+// The traces that the wildcards of DependencyV5.txt and the locations read by
+// LibV2 and LibV5 select, all copies of the benchmarked trace. Two traces per
+// stimulus let the LibV2 features average and fit over stimuli.
+static const WildcardTrace wildcardTraces[] = {
+    {";APWaveForm200", 0.2},    {";APWaveForm300", 0.3},
+    {";APDrop200", 0.2},        {";APDrop300", 0.3},
+    {";IDrest150", 0.15},       {";IDrest250", 0.25},
+    {";IDthreshold100", 0.1},   {";IDthreshold120", 0.12},
+    {";location_soma", 0.},     {";location_dend1", 0.},
+    {";location_dend2", 0.},    {";location_dend620", 0.},
+    {";location_dend800", 0.},  {";location_AIS", 0.},
+    {";location_epsp", 0.}};
+
+static bool matches(const string& name, const string& filter) {
+  return filter.empty() || name.find(filter) != string::npos;
+}
+
+static void benchKernels(const Trace& trace, const ExecutionPlan& plan,
+                         const vector<Kernel>& kernels, unsigned repetitions,
+                         const string& filter) {
+  TraceData base;
+  setDefaultSettings(base.intData, base.doubleData);
+  setFeatureSettings(base.doubleData);
+  base.doubleData["T"] = trace.t;
+  base.doubleData["V"] = trace.v;
+  base.doubleData["stim_start"] = vector<double>(1, trace.stimStart);
+  base.doubleData["stim_end"] = vector<double>(1, trace.stimEnd);
+  base.strData["params"] = "";
+
+  // the samples the kernels work on
+  TraceData interpolated(base);
+  LibV1::interpolate(interpolated.intData, interpolated.doubleData,
+                     interpolated.strData);
+  const size_t samples = interpolated.doubleData["V"].size();
+
+  // the copies are taken after the interpolation, like the traces of the
+  // other stimuli and locations would be given
+  TraceData wildcardBase(base);
+  for (size_t i = 0; i < sizeof(wildcardTraces) / sizeof(wildcardTraces[0]);
+       i++) {
+    const string params(wildcardTraces[i].params);
+    wildcardBase.doubleData["T" + params] = interpolated.doubleData["T"];
+    wildcardBase.doubleData["V" + params] = interpolated.doubleData["V"];
+    wildcardBase.doubleData["stim_start" + params] =
+        base.doubleData["stim_start"];
+    wildcardBase.doubleData["stim_end" + params] = base.doubleData["stim_end"];
+    wildcardBase.doubleData["stimulus_current" + params] =
+        vector<double>(1, wildcardTraces[i].stimulusCurrent);
+    // AP_phaseslope reads its range with the params of the trace
+    wildcardBase.doubleData["AP_phaseslope_range" + params] =
+        base.doubleData["AP_phaseslope_range"];
+  }
+
+  for (size_t k = 0; k < kernels.size(); k++) {
+    const Kernel& kernel = kernels[k];
+    if (kernel.status != NULL || !matches(kernel.name, filter)) continue;
+
+    Measurement best = Measurement();
+    int retval = 0;
+    for (unsigned r = 0; r < repetitions; r++) {
+      TraceData data(kernel.wildcards ? wildcardBase : base);
+      runSteps(plan, kernel.dependencies, data);
+      keepBest(best, measure([&]() {
+        retval = kernel.function(data.intData, data.doubleData, data.strData);
+      }), r);
+      // failures are expected on traces without the right spikes, don't let
+      // their messages pile up
+      GErrorStr.clear();
+    }
+    report(trace, samples, kernel.name, retval < 0 ? "failed" : "ok", best);
+  }
+}
+
+static void benchUtils(const Trace& trace, unsigned repetitions,
+                       const string& filter) {
+  Measurement best = Measurement();
+  vector<double> t, v;
+  if (matches("LinearInterpolation", filter)) {
+    for (unsigned r = 0; r < repetitions; r++) {
+      t = vector<double>();
+      v = vector<double>();
+      keepBest(best, measure([&]() {
+        LinearInterpolation(0.1, trace.t, trace.v, t, v);
+      }), r);
+    }
+  }
+  t = vector<double>();
+  v = vector<double>();
+  LinearInterpolation(0.1, trace.t, trace.v, t, v);
+  if (matches("LinearInterpolation", filter)) {
+    report(trace, v.size(), "LinearInterpolation", "ok", best);
+  }
+
+  vector<double> dv;
+  if (matches("getCentralDifferenceDerivative", filter)) {
+    for (unsigned r = 0; r < repetitions; r++) {
+      dv = vector<double>();
+      keepBest(best, measure([&]() {
+        getCentralDifferenceDerivative(0.1, v, dv);
+      }), r);
+    }
+    report(trace, v.size(), "getCentralDifferenceDerivative", "ok", best);
+  }
+  if (matches("getCentralDifferenceDvdt", filter)) {
+    for (unsigned r = 0; r < repetitions; r++) {
+      dv = vector<double>();
+      keepBest(best, measure([&]() {
+        getCentralDifferenceDvdt(v, t, dv);
+      }), r);
+    }
+    report(trace, v.size(), "getCentralDifferenceDvdt", "ok", best);
+  }
+  if (matches("getfivepointstencilderivative", filter)) {
+    for (unsigned r = 0; r < repetitions; r++) {
+      dv = vector<double>();
+      keepBest(best, measure([&]() {
+        getfivepointstencilderivative(v, dv);
+      }), r);
+    }
+    report(trace, v.size(), "getfivepointstencilderivative", "ok", best);
+  }
+}
+
+static int benchLoader(const string& depFile,
+                       std::map<string, feature2function*>& libs,
+                       unsigned repetitions, ExecutionPlan& plan) {
+  Measurement best = Measurement();
+  int retval = 0;
+  for (unsigned r = 0; r < repetitions; r++) {
+    feature2function table;
+    std::map<string, vector<featureStringPair> > lookup;
+    plan.clear();
+    keepBest(best, measure([&]() {
+      cTree tree(depFile.c_str());
+      retval = tree.setFeaturePointers(libs, &table, &lookup, &plan);
+      if (retval < 0) GErrorStr = tree.ErrorStr;
+    }), r);
+  }
+  report(noTrace(), 0, "dependency_loader", retval < 0 ? "failed" : "ok",
+         best);
+  return retval;
+}
+
+struct TraceFile {
+  const char* name;
+  double stimStart, stimEnd;
+};
+
+// the traces and stimuli of the tests
+static const TraceFile testTraces[] = {
+    {"mean_frequency_1.txt", 500., 900.},
+    {"ahptest_1.txt", 700., 2700.},
+    {"spike_outside_stim.txt", 700., 2700.},
+    {"sagtrace_1.txt", 800., 3800.},
+    {"init_burst1.txt", 250., 1600.},
+    {"derivwindow.txt", 100., 1000.},
+    {"tau20.0.csv", 100., 1000.},
+    {"zero_ISI_log_slope_skip95824004.abf.csv", 31.2, 431.2}};
+
+int main(int argc, char** argv) {
+  string depFile = EFEL_DIR "/DependencyV5.txt";
+  unsigned repetitions = 5;
+  vector<int> scales;
+  string filter;
+  vector<string> traceArgs;
+  vector<string> syntheticArgs;
+  for (int i = 1; i < argc; i++) {
+    const string arg(argv[i]);
+    if (i + 1 < argc && arg == "-d") {
+      depFile = argv[++i];
+    } else if (i + 1 < argc && arg == "-r") {
+      repetitions = std::max(1, atoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "-s") {
+      scales.push_back(std::max(1, atoi(argv[++i])));
+    } else if (i + 1 < argc && arg == "-f") {
+      filter = argv[++i];
+    } else if (i + 1 < argc && arg == "-g") {
+      syntheticArgs.push_back(argv[++i]);
+    } else if (!arg.empty() && arg[0] != '-') {
+      traceArgs.push_back(arg);
+    } else {
+      fprintf(stderr,
+              "Usage: %s [-d dependency_file] [-r repetitions] [-s scale]... "
+              "[-f name_filter] [-g spike_rate_hz:sampling_khz]... "
+              "[trace_file:stim_start:stim_end]...\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (scales.empty()) {
+    scales.push_back(1);
+    scales.push_back(10);
+  }
+
+  vector<Trace> traces;
+  if (traceArgs.empty() && syntheticArgs.empty()) {
+    syntheticArgs.push_back("10:20");
+    syntheticArgs.push_back("200:20");
+    for (size_t i = 0; i < sizeof(testTraces) / sizeof(testTraces[0]); i++) {
+      Trace trace;
+      trace.stimStart = testTraces[i].stimStart;
+      trace.stimEnd = testTraces[i].stimEnd;
+      const string path =
+          string(EFEL_DIR "/tests/testdata/basic/") + testTraces[i].name;
+      if (!loadTrace(path, trace)) {
+        fprintf(stderr, "Can't read trace %s\n", path.c_str());
+        return 1;
+      }
+      traces.push_back(trace);
+    }
+  }
+  for (size_t i = 0; i < traceArgs.size(); i++) {
+    Trace trace;
+    const string& arg = traceArgs[i];
+    size_t stimEnd = arg.find_last_of(':');
+    size_t stimStart =
+        stimEnd == string::npos ? stimEnd : arg.find_last_of(':', stimEnd - 1);
+    if (stimStart == string::npos) {
+      fprintf(stderr, "Traces are given as file:stim_start:stim_end\n");
+      return 1;
+    }
+    trace.stimStart = atof(arg.substr(stimStart + 1).c_str());
+    trace.stimEnd = atof(arg.substr(stimEnd + 1).c_str());
+    if (!loadTrace(arg.substr(0, stimStart), trace)) {
+      fprintf(stderr, "Can't read trace %s\n", arg.c_str());
+      return 1;
+    }
+    traces.push_back(trace);
+  }
+  // one second of a 10 mV step with spikes, traces of scale s last s seconds
+  for (size_t i = 0; i < syntheticArgs.size(); i++) {
+    const string& arg = syntheticArgs[i];
+    const size_t colon = arg.find(':');
+    const double rate = atof(arg.c_str());
+    const double khz =
+        colon == string::npos ? 0. : atof(arg.substr(colon + 1).c_str());
+    if (!(khz > 0.)) {
+      fprintf(stderr, "Synthetic traces are given as rate_hz:sampling_khz\n");
+      return 1;
+    }
+    Trace trace;
+    trace.name = "synthetic_" + arg.substr(0, colon) + "Hz_" +
+                 arg.substr(colon + 1) + "kHz";
+    trace.scale = 1;
+    trace.synthetic["duration"] = vector<double>(1, 1000.);
+    trace.synthetic["dt"] = vector<double>(1, 1. / khz);
+    trace.synthetic["stim_start"] = vector<double>(1, 100.);
+    trace.synthetic["stim_end"] = vector<double>(1, 900.);
+    trace.synthetic["spike_rate"] = vector<double>(1, rate);
+    trace.synthetic["noise"] = vector<double>(1, 0.5);
+    traces.push_back(trace);
+  }
+
+  FillFptrTable();
+  std::map<string, feature2function*> libs;
+  libs["LibV1"] = &FptrTableV1;
+  libs["LibV2"] = &FptrTableV2;
+  libs["LibV3"] = &FptrTableV3;
+  libs["LibV4"] = &FptrTableV4;
+  libs["LibV5"] = &FptrTableV5;
+
+  printf("trace\tscale\tsamples\tbenchmark\tstatus\tns\tns_per_sample\t"
+         "allocations\tbytes\n");
+  ExecutionPlan plan;
+  if (benchLoader(depFile, libs, repetitions, plan) < 0) {
+    fprintf(stderr, "Can't load %s: %s\n", depFile.c_str(),
+            GErrorStr.c_str());
+    return 1;
+  }
+  vector<Kernel> kernels;
+  findKernels(plan, libs, kernels);
+  for (size_t k = 0; k < kernels.size(); k++) {
+    if (kernels[k].status != NULL && matches(kernels[k].name, filter)) {
+      report(noTrace(), 0, kernels[k].name, kernels[k].status, Measurement());
+    }
+  }
+
+  for (size_t i = 0; i < scales.size(); i++) {
+    for (size_t j = 0; j < traces.size(); j++) {
+      const Trace trace = scaleTrace(traces[j], scales[i]);
+      benchUtils(trace, repetitions, filter);
+      benchKernels(trace, plan, kernels, repetitions, filter);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Measures the throughput of LinearInterpolation on long traces and checks
+ * that it gives exactly the same results as the previous push_back based
+ * implementation, which is kept here as a reference.
+ */
+
+#include "Utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <math.h>
+
+// LinearInterpolation as it was before it got the uniform sampling fast path
+static int oldLinearInterpolation(double Stepdx,
+                                  const vector<double>& X,
+                                  const vector<double>& Y,
+                                  vector<double>& InterpX,
+                                  vector<double>& InterpY) {
+  EFEL_ASSERT(X.size() == Y.size(), "X & Y have to have the same point count");
+  EFEL_ASSERT(2 < X.size(), "Need at least 2 points in X");
+  EFEL_ASSERT(Stepdx > 0, "Interpolation step needs to be strictly positive");
+
+  double dx, dy, dydx;
+  size_t InterpX_size;
+  double x = X[0];
+  double start = X[0];
+  double stop = X[X.size() - 1] + Stepdx;
+
+  // Inspired by the way numpy.arange works
+  // Do not remove the 'ceil' in favor of < stop in for loop
+  InterpX_size = ceil((stop - start)/Stepdx);
+
+  for (size_t i = 0; i < InterpX_size; i++) {
+      InterpX.push_back(x);
+      x += Stepdx;
+  }
+
+  // Create the y values
+  unsigned j = 0;
+  for (unsigned i = 0; i < InterpX.size(); i++) {
+    x = InterpX[i];
+
+    EFEL_ASSERT((j+1) < X.size(), "Interpolation accessing point outside of X");
+
+    while ( X[j+1] < x ) {
+        j++;
+        if (j+1 >= X.size()) {
+            j = X.size() - 1;
+            break;
+        }
+        EFEL_ASSERT((j+1) < X.size(),
+                "Interpolation accessing point outside of X");
+    }
+
+
+
+    if (j == X.size() - 1) {
+        // Last point
+        InterpY.push_back(Y[j]);
+        break;
+    }
+    else {
+        EFEL_ASSERT((j+1) < X.size(),
+                "Interpolation accessing point outside of X");
+
+        dx = X[j+1] - X[j];
+        dy = Y[j+1] - Y[j];
+
+        EFEL_ASSERT(dx != 0,  "Interpolation using dx == 0"); //!=0 per definition
+
+        dydx = dy/dx;
+
+        InterpY.push_back(Y[j] + dydx * (x - X[j]));
+    }
+  }
+
+  return 1;
+}
+
+typedef int (*interpolation_function)(double, const vector<double>&,
+                                      const vector<double>&, vector<double>&,
+                                      vector<double>&);
+
+static double timeInterpolation(interpolation_function interpolate,
+                                double step, const vector<double>& t,
+                                const vector<double>& v,
+                                vector<double>& interp_t,
+                                vector<double>& interp_v) {
+  interp_t.clear();
+  interp_v.clear();
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  interpolate(step, t, v, interp_t, interp_v);
+  std::chrono::steady_clock::time_point stop =
+      std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+static void run(const char* name, double step, const vector<double>& t,
+                const vector<double>& v) {
+  vector<double> old_t, old_v, new_t, new_v;
+  double old_s =
+      timeInterpolation(oldLinearInterpolation, step, t, v, old_t, old_v);
+  double new_s =
+      timeInterpolation(LinearInterpolation, step, t, v, new_t, new_v);
+
+  printf("%s: %d samples -> %d samples\n", name, (int)t.size(),
+         (int)new_v.size());
+  printf("  previous implementation: %8.1f Msamples/s\n",
+         t.size() / old_s / 1e6);
+  printf("  LinearInterpolation:     %8.1f Msamples/s\n",
+         t.size() / new_s / 1e6);
+  if (old_t != new_t || old_v != new_v) {
+    printf("  RESULTS DIFFER\n");
+    exit(1);
+  }
+}
+
+int main(int argc, char** argv) {
+  const size_t n = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  vector<double> t(n), v(n);
+  double time = 0.;
+  for (size_t i = 0; i < n; i++) {
+    t[i] = time;
+    v[i] = -65. + 40. * sin(i * 0.001) * sin(i * 0.0173);
+    time += 0.025;
+  }
+  // the usual simulator output, resampled at a larger step
+  run("uniform 0.025 ms -> 0.1 ms", 0.1, t, v);
+  // resampling at the same step
+  run("uniform 0.025 ms -> 0.025 ms", 0.025, t, v);
+
+  // variable time step
+  time = 0.;
+  for (size_t i = 0; i < n; i++) {
+    t[i] = time;
+    time += 0.005 + 0.04 * (i % 7) / 7.;
+  }
+  run("variable step -> 0.1 ms", 0.1, t, v);
+
+  return 0;
+}
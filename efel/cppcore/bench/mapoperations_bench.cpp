@@ -0,0 +1,110 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Measures the cost of the feature store lookup that every feature function
+ * does through CheckIn(Int|Double)map / get(Int|Double)Vec, compared with
+ * the ordered std::map store that was used before.
+ */
+
+#include "cfeature.h"
+#include "mapoperations.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+
+typedef std::map<string, vector<double> > orderedStr2doubleVec;
+typedef std::map<string, string> orderedStr2Str;
+
+// The lookup as done by CheckInDoublemap on the ordered store
+static int orderedCheckInDoublemap(orderedStr2doubleVec& DoubleFeatureData,
+                                   orderedStr2Str& StringData,
+                                   string strFeature, int& nSize) {
+  string params;
+  orderedStr2Str::const_iterator params_it(StringData.find("params"));
+  if (params_it != StringData.end()) {
+    params = params_it->second;
+  }
+  strFeature += params;
+  orderedStr2doubleVec::const_iterator mapstr2DoubleItr(
+      DoubleFeatureData.find(strFeature));
+  if (mapstr2DoubleItr != DoubleFeatureData.end()) {
+    nSize = mapstr2DoubleItr->second.size();
+    return 1;
+  }
+  nSize = -1;
+  return 0;
+}
+
+template <typename Store, typename StrStore, typename Lookup>
+static double timeLookups(Store& store, StrStore& strStore,
+                          const vector<string>& names, Lookup lookup,
+                          unsigned repeats) {
+  int size, found = 0;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  for (unsigned r = 0; r < repeats; r++) {
+    for (size_t i = 0; i < names.size(); i++) {
+      found += lookup(store, strStore, names[i], size);
+    }
+  }
+  std::chrono::steady_clock::time_point stop =
+      std::chrono::steady_clock::now();
+  if (found == 0) {
+    printf("No features found\n");
+  }
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  return ns / (static_cast<double>(repeats) * names.size());
+}
+
+int main(int argc, char** argv) {
+  const unsigned repeats = argc > 1 ? atoi(argv[1]) : 2000;
+
+  vector<string> names;
+  cFeature feature("", "");
+  feature.get_feature_names(names);
+
+  const string params[] = {"", ";location_soma"};
+  for (size_t p = 0; p < 2; p++) {
+    orderedStr2doubleVec ordered;
+    orderedStr2Str orderedStr;
+    mapStr2doubleVec hashed;
+    mapStr2Str hashedStr;
+
+    for (size_t i = 0; i < names.size(); i++) {
+      for (size_t q = 0; q < 2; q++) {
+        ordered[names[i] + params[q]] = vector<double>(10, 1.);
+        hashed[names[i] + params[q]] = vector<double>(10, 1.);
+      }
+    }
+    orderedStr["params"] = params[p];
+    hashedStr["params"] = params[p];
+
+    double ordered_ns = timeLookups(ordered, orderedStr, names,
+                                    orderedCheckInDoublemap, repeats);
+    double hashed_ns =
+        timeLookups(hashed, hashedStr, names, CheckInDoublemap, repeats);
+
+    printf("params='%s' features=%d\n", params[p].c_str(), (int)names.size());
+    printf("  std::map store:      %8.1f ns/lookup\n", ordered_ns);
+    printf("  hashed store:        %8.1f ns/lookup\n", hashed_ns);
+  }
+
+  return 0;
+}
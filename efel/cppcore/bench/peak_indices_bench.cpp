@@ -0,0 +1,128 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Measures the throughput of the threshold crossing spike detection used by
+ * peak_indices and checks that findThresholdPeaks gives exactly the same
+ * peaks and crossing counts as the previous two pass implementation, which
+ * is kept here as a reference.
+ */
+
+#include "Utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <math.h>
+
+// The spike detection of peak_indices as it was before findThresholdPeaks
+static int oldPeakIndices(const vector<double>& V, double threshold,
+                          vector<int>& PeakIndex, size_t& upCrossings,
+                          size_t& downCrossings) {
+  vector<int> upVec, dnVec;
+  double dtmp;
+  int itmp;
+
+  for (unsigned i = 1; i < V.size(); i++) {
+    if (V[i] > threshold && V[i - 1] < threshold) {
+      upVec.push_back(i);
+    } else if (V[i] < threshold && V[i - 1] > threshold) {
+      dnVec.push_back(i);
+    }
+  }
+  upCrossings = upVec.size();
+  downCrossings = dnVec.size();
+
+  PeakIndex.clear();
+  for (unsigned i = 0; i < upVec.size() && i < dnVec.size(); i++) {
+    dtmp = -1e9;
+    itmp = -1;
+    for (int j = upVec[i]; j <= dnVec[i]; j++) {
+      if (dtmp < V[j]) {
+        dtmp = V[j];
+        itmp = j;
+      }
+    }
+    if (itmp != -1) PeakIndex.push_back(itmp);
+  }
+  return PeakIndex.size();
+}
+
+typedef int (*peak_function)(const vector<double>&, double, vector<int>&,
+                             size_t&, size_t&);
+
+static double timePeaks(peak_function peaks, const vector<double>& v,
+                        double threshold, vector<int>& peak_indices,
+                        size_t& up, size_t& down) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  peaks(v, threshold, peak_indices, up, down);
+  std::chrono::steady_clock::time_point stop =
+      std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+static void check(const char* name, const vector<double>& v,
+                  double threshold, bool verbose) {
+  vector<int> old_peaks, new_peaks;
+  size_t old_up, old_down, new_up, new_down;
+  double old_s =
+      timePeaks(oldPeakIndices, v, threshold, old_peaks, old_up, old_down);
+  double new_s = timePeaks(findThresholdPeaks, v, threshold, new_peaks,
+                           new_up, new_down);
+
+  if (verbose) {
+    printf("%s: %d samples, %d peaks\n", name, (int)v.size(),
+           (int)new_peaks.size());
+    printf("  previous implementation: %8.1f Msamples/s\n",
+           v.size() / old_s / 1e6);
+    printf("  findThresholdPeaks:      %8.1f Msamples/s\n",
+           v.size() / new_s / 1e6);
+  }
+  if (old_peaks != new_peaks || old_up != new_up || old_down != new_down) {
+    printf("%s: RESULTS DIFFER\n", name);
+    exit(1);
+  }
+}
+
+int main(int argc, char** argv) {
+  const size_t n = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  // spikes of 1 ms every 20 ms at a step of 0.025 ms
+  vector<double> v(n);
+  for (size_t i = 0; i < n; i++) {
+    double phase = fmod(i * 0.025, 20.);
+    v[i] = phase < 1. ? -65. + 100. * sin(phase * M_PI) : -65. + phase * 0.5;
+  }
+  check("regular spiking", v, -20., true);
+  check("no spikes", v, 50., true);
+
+  // noisy traces on the threshold, with samples exactly at the threshold and
+  // traces starting or ending above it
+  srand(1);
+  for (int trace = 0; trace < 10000; trace++) {
+    vector<double> noisy(1 + rand() % 200);
+    for (size_t i = 0; i < noisy.size(); i++) {
+      noisy[i] = -20. + (rand() % 5 - 2) * 10.;
+    }
+    check("noisy trace", noisy, -20., false);
+  }
+  printf("noisy traces: same results\n");
+
+  return 0;
+}
@@ -18,8 +18,11 @@
 
 #include "cfeature.h"
 #include "Global.h"
+#include "Utils.h"
 
+#include <chrono>
 #include <cstdlib>
+#include <utility>
 #include <iostream>
 
 #include <time.h>
@@ -28,11 +31,17 @@ using std::cout;
 using std::endl;
 
 
+// The library function pointer tables are shared by all the cFeature
+// instances and are never modified after being filled here
+static void fillFptrTableOnce() {
+  static const int filled = FillFptrTable();
+  (void)filled;
+}
 
 cFeature::cFeature(const string& strDepFile, const string& outdir)
-  : logger(outdir)
+  : profiling(false), logger(outdir)
 {
-  FillFptrTable();
+  fillFptrTableOnce();
   mapFptrLib["LibV1"] = &FptrTableV1;
   mapFptrLib["LibV2"] = &FptrTableV2;
   mapFptrLib["LibV3"] = &FptrTableV3;
@@ -41,37 +50,48 @@ cFeature::cFeature(const string& strDepFile, const string& outdir)
 
   fillfeaturetypes();
 
-  cTree DepTree(strDepFile.c_str());
+  depTables = getDependencyTables(strDepFile, mapFptrLib);
   // get Error
-  if (DepTree.ErrorStr.length() != 0) {
-    GErrorStr = DepTree.ErrorStr;
-  }
-  int retVal = DepTree.setFeaturePointers(mapFptrLib, &FptrTable, &fptrlookup);
-  if (retVal < 0) {
-    GErrorStr = DepTree.ErrorStr;
+  if (!depTables->ErrorStr.empty()) {
+    GErrorStr = depTables->ErrorStr;
   }
+  fptrlookup = depTables->fptrlookup;
+  resetPlanState();
 
-  // log output
+  logSession(strDepFile);
+}
+
+void cFeature::logSession(const string& strDepFile) {
   time_t rawtime;
   time(&rawtime);
-  logger << "\n" << ctime(&rawtime) << "Initializing new session." << endl;
-  logger << "Using dependency file: " << strDepFile << endl;
+  EFEL_LOG(logger, EFEL_LOG_INFO) << "\n" << ctime(&rawtime)
+                                  << "Initializing new session.";
+  EFEL_LOG(logger, EFEL_LOG_INFO) << "Using dependency file: " << strDepFile;
 }
 
-int cFeature::setVersion(string strDepFile) {
-  FptrTable.clear();
-  /*
-  map<string, vector< pair< fptr, string > > >::iterator mapVecItr;
-  vector< pair< fptr, string > > *vecFptr;
-  for(mapVecItr = pFeature->fptrlookup.begin(); mapVecItr !=
-  pFeature->fptrlookup.end(); mapVecItr++){
-      vecFptr   = &(mapVecItr->second);
-      vecFptr->clear();
+bool cFeature::usesDependencyFile(const string& strDepFile) {
+  return getDependencyTables(strDepFile, mapFptrLib) == depTables;
+}
+
+void cFeature::resetData(const string& strDepFile) {
+  mapIntData.clear();
+  mapDoubleData.clear();
+  mapStrData.clear();
+  intSettings.clear();
+  doubleSettings.clear();
+  traceFile.reset();
+  resetPlanState();
+  if (!depTables->ErrorStr.empty()) {
+    GErrorStr = depTables->ErrorStr;
   }
-  */
-  fptrlookup.clear();
-  cTree DepTree(strDepFile.c_str());
-  DepTree.setFeaturePointers(mapFptrLib, &FptrTable, &fptrlookup);
+
+  logSession(strDepFile);
+}
+
+int cFeature::setVersion(string strDepFile) {
+  depTables = getDependencyTables(strDepFile, mapFptrLib);
+  fptrlookup = depTables->fptrlookup;
+  resetPlanState();
   return 1;
 }
 
@@ -256,7 +276,7 @@ void cFeature::get_feature_names(vector<string>& feature_names) {
 }
 
 vector<int>& cFeature::getmapIntData(string strName) {
-  map<string, vector<int> >::iterator mapstr2IntItr;
+  mapStr2intVec::iterator mapstr2IntItr;
   mapstr2IntItr = mapIntData.find(strName);
   if (mapstr2IntItr == mapIntData.end()) {
     GErrorStr += "Feature [" + strName + "] data is missing\n";
@@ -264,7 +284,8 @@ vector<int>& cFeature::getmapIntData(string strName) {
   return mapstr2IntItr->second;
 }
 vector<double>& cFeature::getmapDoubleData(string strName) {
-  map<string, vector<double> >::iterator mapstr2DoubleItr;
+  loadTraceFile();
+  mapStr2doubleVec::iterator mapstr2DoubleItr;
   mapstr2DoubleItr = mapDoubleData.find(strName);
   if (mapstr2DoubleItr == mapDoubleData.end()) {
     GErrorStr += "Feature [" + strName + "] data is missing\n";
@@ -284,23 +305,24 @@ int cFeature::getmapfptrVec(string strName, vector<fptr> &vFptr){
 */
 
 int cFeature::printMapMember(FILE* fp) {
-  map<string, vector<int> >::iterator mapstr2IntItr;
+  mapStr2intVec::iterator mapstr2IntItr;
   fprintf(fin, "\n\n\n IntData.....");
   for (mapstr2IntItr = mapIntData.begin(); mapstr2IntItr != mapIntData.end();
        mapstr2IntItr++)
     fprintf(fin, "\n\t%s", mapstr2IntItr->first.c_str());
   fprintf(fin, "\n\n DoubleData..........");
-  map<string, vector<double> >::iterator mapstr2DoubleItr;
+  mapStr2doubleVec::iterator mapstr2DoubleItr;
   for (mapstr2DoubleItr = mapDoubleData.begin();
        mapstr2DoubleItr != mapDoubleData.end(); mapstr2DoubleItr++)
     fprintf(fin, "\n\t%s", mapstr2DoubleItr->first.c_str());
   return 1;
 }
 
-int cFeature::setFeatureInt(string strName, vector<int>& v) {
-  logger << "Set " << strName << ":" << v << endl;
+int cFeature::setFeatureInt(string strName, vector<int> v) {
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Set " << strName << ":" << v;
   // printf ("Setting int feature [%s] = %d\n", strName.c_str(),v[0]);
-  mapIntData[strName] = v;
+  mapIntData[strName] = std::move(v);
+  resetPlanState();
   return 1;
 }
 
@@ -313,42 +335,125 @@ int cFeature::setFeatureInt(string strName, vector<int>& v) {
  *  e.g. (";APWaveForm200;soma", ";APWaveForm240;soma", ...)
  */
 void cFeature::getTraces(const string& wildcards, vector<string>& params) {
-  map<string, vector<double> >::const_iterator map_it;
-  string featurename;
-  params.clear();
-  for (map_it = mapDoubleData.begin(); map_it != mapDoubleData.end();
-       ++map_it) {
-    featurename = map_it->first;
-    // find traces
-    if (featurename.find("V;") != string::npos) {
-      bool match = true;
-      int nextpos;
-      int oldpos = 1;
-      do {
-        string param;
-        nextpos = wildcards.find(";", oldpos + 1);
-        if (nextpos == -1) {
-          nextpos = wildcards.size();
-        }
-        param = wildcards.substr(oldpos, nextpos - oldpos - 1);
-        if (featurename.find(param) == string::npos) {
-          match = false;
-          break;
-        }
-        oldpos = nextpos;
-      } while (nextpos != (int)wildcards.size());
-      if (match) {
-        params.push_back(featurename.substr(1));
-      }
+  ::getTraces(mapDoubleData, wildcards, params);
+}
+
+/*
+ * Forget which plan steps already ran, any change of the data can change
+ * their outcome. Steps whose result is still stored in the data maps return
+ * it right away when they run again.
+ */
+void cFeature::resetPlanState() {
+  stepStatus.assign(depTables->plan.steps.size(), 0);
+  stepErrors.assign(depTables->plan.steps.size(), string());
+  stepErrorCodes.assign(depTables->plan.steps.size(), EFEL_ERROR_NONE);
+  traceBindings.clear();
+}
+
+void cFeature::setParams(const string& params) {
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Set params: " << params;
+  mapStrData["params"] = params;
+}
+
+int cFeature::runStep(const featureStringPair& step) {
+  feature_function function = step.first;
+  const string& wildcard = step.second;
+  if (wildcard.empty()) {
+    // make sure that
+    //  - the feature is called only once
+    //  - the feature operates on "V" and "T" if it operates on traces at all
+    setParams("");
+    return function(mapIntData, mapDoubleData, mapStrData) < 0 ? -1 : 1;
+  }
+
+  // make sure that
+  //  -the feature is called once for every trace according to the wildcard
+  //  -the feature operates on each trace
+  std::map<string, vector<string> >::iterator binding(
+      traceBindings.find(wildcard));
+  if (binding == traceBindings.end()) {
+    // TODO
+    // read stimulus configuration file and parse additional parameters
+    // such as number of required traces
+    binding = traceBindings.insert(
+        std::make_pair(wildcard, vector<string>())).first;
+    getTraces(wildcard, binding->second);
+  }
+  const vector<string>& params = binding->second;
+  if (params.empty()) {
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "\nMissing trace with wildcards " + wildcard;
+    }
+    return -2;
+  }
+  int status = 1;
+  for (unsigned i = 0; i < params.size(); i++) {
+    // setting the "params" entry here makes sure that the required features
+    // require specific traces also
+    setParams(params[i]);
+    status = function(mapIntData, mapDoubleData, mapStrData) < 0 ? -1 : 1;
+  }
+  return status;
+}
+
+static size_t storedSize(const mapStr2intVec& intData,
+                         const mapStr2doubleVec& doubleData,
+                         const string& key) {
+  mapStr2intVec::const_iterator intIt(intData.find(key));
+  if (intIt != intData.end()) return intIt->second.size();
+  mapStr2doubleVec::const_iterator doubleIt(doubleData.find(key));
+  if (doubleIt != doubleData.end()) return doubleIt->second.size();
+  return 0;
+}
+
+int cFeature::runProfiledStep(unsigned step) {
+  const ExecutionPlan& plan = depTables->plan;
+  const featureStringPair& planStep = plan.steps[step];
+  const size_t cacheHits = GCacheHits;
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  const int status = runStep(planStep);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  StepProfile& stepProfile = profile[plan.stepNames[step]];
+  stepProfile.seconds += elapsed.count();
+  stepProfile.cacheHits += GCacheHits - cacheHits;
+  if (status == -2) return status;
+
+  // the values are stored under the feature name with the params of every
+  // trace the function ran on appended, see runStep
+  const string& feature = plan.stepFeatures[step];
+  if (planStep.second.empty()) {
+    stepProfile.calls++;
+    stepProfile.outputSize += storedSize(mapIntData, mapDoubleData, feature);
+  } else {
+    const vector<string>& params = traceBindings[planStep.second];
+    stepProfile.calls += params.size();
+    for (size_t i = 0; i < params.size(); i++) {
+      stepProfile.outputSize +=
+          storedSize(mapIntData, mapDoubleData, feature + params[i]);
     }
   }
+  return status;
+}
+
+// Code of a step that failed. Without the messages of the map operations
+// only the feature functions write to GErrorStr, a step that explains its
+// failure did not just miss a parameter on the way.
+static int stepErrorCode(bool wroteMessage) {
+  if (GErrorCode == EFEL_ERROR_NONE || (wroteMessage && !GErrorMessages)) {
+    return EFEL_ERROR_FEATURE_FAILED;
+  }
+  return GErrorCode;
 }
 
 int cFeature::calc_features(const string& name) {
+  const ExecutionPlan& plan = depTables->plan;
   // stimulus extension
-  map<string, vector<featureStringPair> >::const_iterator lookup_it(
-      fptrlookup.find(name));
-  if (lookup_it == fptrlookup.end()) {
+  map<string, vector<unsigned> >::const_iterator plan_it(
+      plan.featureSteps.find(name));
+  if (plan_it == plan.featureSteps.end()) {
     fprintf(stderr,
             "\nFeature [ %s ] dependency file entry or pointer table entry is "
             "missing. Exiting\n",
@@ -357,52 +462,38 @@ int cFeature::calc_features(const string& name) {
     exit(1);
   }
 
+  loadTraceFile();
+
   bool last_failed = false;
 
-  for (vector<featureStringPair>::const_iterator pfptrstring =
-           lookup_it->second.begin();
-       pfptrstring != lookup_it->second.end(); ++pfptrstring) {
-    // set parameters, for now only the wildcard 'stimulusname'
-    //
-    feature_function function = pfptrstring->first;
-    string wildcard = pfptrstring->second;
-    if (wildcard.empty()) {
-      // make sure that
-      //  - the feature is called only once
-      //  - the feature operates on "V" and "T" if it operates on traces at all
-      setFeatureString("params", "");
-      if (function(mapIntData, mapDoubleData, mapStrData) < 0) {
-        // GErrorStr += "\nFeature [" + name + "] called twice, or doesn't
-        // operate on V and T.";
-        // return -1;i
-        last_failed = true;
-      } else {
-        last_failed = false;
-      }
-    } else {
-      // make sure that
-      //  -the feature is called once for every trace according to the wildcard
-      //  -the feature operates on each trace
-      vector<string> params;
-      // TODO
-      // read stimulus configuration file and parse additional parameters
-      // such as number of required traces
-      getTraces(wildcard, params);
-      if (params.empty()) {
-        GErrorStr += "\nMissing trace with wildcards " + wildcard;
-        return -1;
-      }
-      for (unsigned i = 0; i < params.size(); i++) {
-        // setting the "params" entry here makes sure that the required features
-        // require specific traces also
-        setFeatureString("params", params[i]);
-        if (function(mapIntData, mapDoubleData, mapStrData) < 0) {
-          last_failed = true;
-        } else {
-          last_failed = false;
+  // Every step runs at most once until the data changes, features that share
+  // dependencies reuse their outcome
+  for (vector<unsigned>::const_iterator step_it = plan_it->second.begin();
+       step_it != plan_it->second.end(); ++step_it) {
+    unsigned step = *step_it;
+    if (stepStatus[step] == 0) {
+      size_t errorPos = GErrorStr.size();
+      const int previousCode = GErrorCode;
+      GErrorCode = EFEL_ERROR_NONE;
+      stepStatus[step] =
+          profiling ? runProfiledStep(step) : runStep(plan.steps[step]);
+      if (stepStatus[step] < 0) {
+        stepErrorCodes[step] = stepErrorCode(GErrorStr.size() > errorPos);
+        if (GErrorStr.size() > errorPos) {
+          stepErrors[step] = GErrorStr.substr(errorPos);
         }
       }
+      // misses of a step that succeeded (optional settings) are no errors
+      GErrorCode = previousCode;
+      if (stepStatus[step] < 0) reportError(stepErrorCodes[step]);
+    } else if (stepStatus[step] < 0) {
+      GErrorStr += stepErrors[step];
+      reportError(stepErrorCodes[step]);
     }
+    if (stepStatus[step] == -2) {
+      return -1;
+    }
+    last_failed = stepStatus[step] < 0;
   }
   if (last_failed) {
     return -1;
@@ -412,47 +503,70 @@ int cFeature::calc_features(const string& name) {
   }
 }
 
-int cFeature::getFeatureInt(string strName, vector<int>& vec) {
-  logger << "Going to calculate feature " << strName << " ..." << endl;
+int cFeature::getFeatureInt(string strName, ConstVecRef<int>& vec) {
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Going to calculate feature " << strName
+                                   << " ...";
   if (calc_features(strName) < 0) {
-    logger << "Failed to calculate feature " << strName << ": " << GErrorStr
-              << endl;
+    EFEL_LOG(logger, EFEL_LOG_WARNING) << "Failed to calculate feature "
+                                       << strName << ": " << GErrorStr;
     return -1;
   }
-  vec = getmapIntData(strName);
+  vec.bind(getmapIntData(strName));
 
-  logger << "Calculated feature " << strName << ":" << vec << endl;
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Calculated feature " << strName << ":"
+                                   << vec.get();
 
   return vec.size();
 }
 
-int cFeature::getFeatureDouble(string strName, vector<double>& vec) {
-  logger << "Going to calculate feature " << strName << " ..." << endl;
+int cFeature::getFeatureInt(string strName, vector<int>& vec) {
+  ConstVecRef<int> values;
+  int retVal = getFeatureInt(strName, values);
+  if (retVal < 0) return retVal;
+  vec = values;
+  return retVal;
+}
+
+int cFeature::getFeatureDouble(string strName, ConstVecRef<double>& vec) {
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Going to calculate feature " << strName
+                                   << " ...";
   if (calc_features(strName) < 0) {
-    logger << "Failed to calculate feature " << strName << ": " << GErrorStr
-              << endl;
+    EFEL_LOG(logger, EFEL_LOG_WARNING) << "Failed to calculate feature "
+                                       << strName << ": " << GErrorStr;
     return -1;
   }
-  vec = getmapDoubleData(strName);
+  vec.bind(getmapDoubleData(strName));
 
-  logger << "Calculated feature " << strName << ":" << vec << endl;
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Calculated feature " << strName << ":"
+                                   << vec.get();
 
   return vec.size();
 }
 
+int cFeature::getFeatureDouble(string strName, vector<double>& vec) {
+  ConstVecRef<double> values;
+  int retVal = getFeatureDouble(strName, values);
+  if (retVal < 0) return retVal;
+  vec = values;
+  return retVal;
+}
+
 int cFeature::setFeatureString(const string& key, const string& value) {
-  logger << "Set " << key << ": " << value << endl;
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Set " << key << ": " << value;
   mapStrData[key] = value;
+  resetPlanState();
   return 1;
 }
 
 int cFeature::getFeatureString(const string& key, string& value) {
-  map<string, string>::const_iterator pstrstr(mapStrData.find(key));
+  mapStr2Str::const_iterator pstrstr(mapStrData.find(key));
   if (pstrstr != mapStrData.end()) {
     value = pstrstr->second;
     return 1;
   } else {
-    GErrorStr += "String parameter [" + key + "] not in map.\n";
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "String parameter [" + key + "] not in map.\n";
+    }
     return -1;
   }
 }
@@ -484,27 +598,108 @@ mapDoubleData.end(); mapItrDouble++){
 }
 */
 
-int cFeature::setFeatureDouble(string strName, vector<double>& v) {
+int cFeature::setSettingInt(const string& strName, vector<int> v) {
+  intSettings[strName] = v;
+  return setFeatureInt(strName, std::move(v));
+}
+
+int cFeature::setSettingDouble(const string& strName, vector<double> v) {
+  doubleSettings[strName] = v;
+  return setFeatureDouble(strName, std::move(v));
+}
+
+int cFeature::resetTrace() {
+  traceFile.reset();
+  mapIntData = intSettings;
+  mapDoubleData = doubleSettings;
+  mapStrData.clear();
+  resetPlanState();
+  return intSettings.size() + doubleSettings.size();
+}
+
+int cFeature::setFeatureDouble(string strName, vector<double> v) {
   if (mapDoubleData.find(strName) != mapDoubleData.end()) {
     if (strName == "V") {
-      logger << "Feature \"V\" set. New trace, clearing maps." << endl;
-      mapDoubleData.clear();
-      mapIntData.clear();
-      mapStrData.clear();
+      EFEL_LOG(logger, EFEL_LOG_INFO)
+          << "Feature \"V\" set. New trace, clearing maps.";
+      resetTrace();
     }
   }
-  mapDoubleData[strName] = v;
-
+  if (strName == "T" || strName == "V") {
+    traceFile.reset();
+  }
   // log data output
-  logger << "Set " << strName << ":" << v << endl;
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Set " << strName << ":" << v;
+
+  clearVoltageDerivatives(mapDoubleData, strName);
+  mapDoubleData[strName] = std::move(v);
+  resetPlanState();
 
   return 1;
 }
 
+int cFeature::setTraceFile(const string& strPath) {
+  std::unique_ptr<MappedTraceFile> file(new MappedTraceFile());
+  string error;
+  if (file->open(strPath, error) < 0) {
+    GErrorStr += "\n" + error + "\n";
+    return -1;
+  }
+  EFEL_LOG(logger, EFEL_LOG_INFO) << "Trace file " << strPath
+                                  << " set. New trace, clearing maps.";
+  resetTrace();
+  traceFile = std::move(file);
+  return 1;
+}
+
+// Traces that have to be resampled are interpolated straight from the
+// mapping, so that only the resampled trace is stored, and the interpolate
+// step is marked as done. Other traces are copied as setFeatureDouble would
+// store them.
+void cFeature::loadTraceFile() {
+  if (!traceFile) return;
+  std::unique_ptr<MappedTraceFile> file(std::move(traceFile));
+
+  double interpStep = 0.1;
+  mapStr2doubleVec::const_iterator it = mapDoubleData.find("interp_step");
+  if (it != mapDoubleData.end() && !it->second.empty()) {
+    interpStep = it->second[0];
+  }
+
+  const size_t n = file->size();
+  vector<double> t, v;
+  const double* tData = file->timeData();
+  if (tData == NULL) {
+    file->readTime(t);
+    tData = t.data();
+  }
+  const double* vData = file->voltageData();
+  if (vData == NULL) {
+    file->readVoltage(v);
+    vData = v.data();
+  }
+
+  if (n > 2 && interpStep > 0 && !isInterpolationGrid(interpStep, tData, n)) {
+    vector<double> tInterp, vInterp;
+    LinearInterpolation(interpStep, tData, vData, n, tInterp, vInterp);
+    t.swap(tInterp);
+    v.swap(vInterp);
+    mapIntData["interpolate"] = vector<int>();
+  } else {
+    if (t.empty()) t.assign(tData, tData + n);
+    if (v.empty()) v.assign(vData, vData + n);
+  }
+  EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Loaded " << n
+                                   << " samples from the trace file, "
+                                   << t.size() << " after interpolation";
+  mapDoubleData["T"] = std::move(t);
+  mapDoubleData["V"] = std::move(v);
+}
+
 int cFeature::printFeature(const char* strFileName) {
   FILE* fp = fopen(strFileName, "w");
   if (fp) {
-    map<string, vector<int> >::iterator mapItrInt;
+    mapStr2intVec::iterator mapItrInt;
     int n = mapIntData.size();
     fprintf(fp, "\n mapIntData.. Total element = [%d]", n);
     for (mapItrInt = mapIntData.begin(); mapItrInt != mapIntData.end();
@@ -518,7 +713,7 @@ int cFeature::printFeature(const char* strFileName) {
       }
     }
 
-    map<string, vector<double> >::iterator mapItrDouble;
+    mapStr2doubleVec::iterator mapItrDouble;
     n = mapDoubleData.size();
     fprintf(fp, "\n mapDoubleData.. Total element = [%d]", n);
     for (mapItrDouble = mapDoubleData.begin();
@@ -612,7 +807,9 @@ string cFeature::featuretype(string featurename) {
   }
   string type(featuretypes[featurename]);
   if (type.empty()) {
-    GErrorStr += featurename + "missing in featuretypes map.\n";
+    if (reportError(EFEL_ERROR_UNKNOWN_FEATURE)) {
+      GErrorStr += featurename + "missing in featuretypes map.\n";
+    }
   }
   return type;
 }
@@ -620,5 +817,6 @@ string cFeature::featuretype(string featurename) {
 string cFeature::getGError() {
   string error(GErrorStr);
   GErrorStr.clear();
+  GErrorCode = EFEL_ERROR_NONE;
   return error;
 }
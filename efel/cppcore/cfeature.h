@@ -20,8 +20,10 @@
 #define CFEATURE_H_
 
 #include "types.h"
+#include "mapoperations.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <math.h>
@@ -29,18 +31,66 @@
 #include "FillFptrTable.h"
 #include "DependencyTree.h"
 #include "eFELLogger.h"
+#include "TraceFile.h"
 
 using std::string;
 using std::vector;
 
+// Cost of a plan step, summed over its runs since the profile was reset
+struct StepProfile {
+  StepProfile() : calls(0), cacheHits(0), seconds(0.), outputSize(0) {}
+  // calls of the feature function, one per trace matching the wildcards
+  size_t calls;
+  // calls that found their values already calculated (CheckIn*map)
+  size_t cacheHits;
+  // wall time
+  double seconds;
+  // number of values the step stored
+  size_t outputSize;
+};
 
+/*
+ * cFeature is the feature extraction engine. Every instance owns its trace
+ * data, its function pointer tables and its logger, so that independent
+ * instances can be used concurrently from different threads. A single
+ * instance must not be shared between threads.
+ */
 class cFeature {
   mapStr2intVec mapIntData;
   mapStr2doubleVec mapDoubleData;
   mapStr2Str mapStrData;
+  // Settings like 'Threshold' survive the start of a new trace, they are
+  // copied back into the data maps by resetTrace
+  mapStr2intVec intSettings;
+  mapStr2doubleVec doubleSettings;
   std::map<string, string> featuretypes;
+  std::map<string, feature2function*> mapFptrLib;
+  // shared with the other engines that use the same dependency file
+  std::shared_ptr<const DependencyTables> depTables;
   FILE* fin;
   void fillfeaturetypes();
+  void logSession(const string& strDepFile);
+
+  // Outcome of every plan step on the current data: 0 if it didn't run yet,
+  // 1 on success, -1 on failure and -2 if no trace matched its wildcards.
+  // The errors of failed steps (message and eFELErrorCode) are kept to
+  // report them again.
+  vector<int> stepStatus;
+  vector<string> stepErrors;
+  vector<int> stepErrorCodes;
+  // Names of the traces matching a wildcard, see getTraces
+  std::map<string, vector<string> > traceBindings;
+  void resetPlanState();
+  int runStep(const featureStringPair& step);
+  void setParams(const string& params);
+
+  bool profiling;
+  std::map<string, StepProfile> profile;
+  int runProfiledStep(unsigned step);
+  // Trace file set by setTraceFile, its samples are moved into "T" and "V"
+  // by loadTraceFile when the first feature is calculated
+  std::unique_ptr<MappedTraceFile> traceFile;
+  void loadTraceFile();
 
  public:
   std::map<string, vector<featureStringPair > > fptrlookup;
@@ -52,10 +102,18 @@ class cFeature {
   cFeature(const string& depFile, const string& outdir);
   int getmapfptrVec(string strName, vector<feature_function>& vFptr);
   int calc_features(const string& name);
-  int setFeatureInt(string strName, vector<int>& intVec);
+  // The setters move the vector into the store, the ConstVecRef getters
+  // give a view of the stored value that is valid until the next "V" is set
+  int setFeatureInt(string strName, vector<int> intVec);
   int getFeatureInt(string strName, vector<int>& vec);
-  int setFeatureDouble(string strName, vector<double>& DoubleVec);
+  int getFeatureInt(string strName, ConstVecRef<int>& vec);
+  int setFeatureDouble(string strName, vector<double> DoubleVec);
   int getFeatureDouble(string strName, vector<double>& vec);
+  int getFeatureDouble(string strName, ConstVecRef<double>& vec);
+  // Use the trace in a binary trace file (see TraceFile.h) as "T" and "V".
+  // This starts a new trace like setting "V", setting "T" or "V" afterwards
+  // replaces the file. Returns -1 if the file can't be used.
+  int setTraceFile(const string& strPath);
   int setFeatureString(const string& key, const string& value);
   int getFeatureString(const string& key, string& value);
   void getTraces(const string& wildcard, vector<string>& traces);
@@ -66,6 +124,20 @@ class cFeature {
   string getGError();
   void get_feature_names(vector<string>& feature_names);
   int setVersion(string strDepFile);
+  // true if the engine uses the current contents of the dependency file
+  bool usesDependencyFile(const string& strDepFile);
+  // drop all data and settings, as if the engine was newly created
+  void resetData(const string& strDepFile);
+  // Settings are kept by resetTrace, which drops all the other data. Setting
+  // a new "V" resets the trace as well. Returns the number of settings.
+  int setSettingInt(const string& strName, vector<int> intVec);
+  int setSettingDouble(const string& strName, vector<double> DoubleVec);
+  int resetTrace();
+  // Opt-in profile of the plan steps run by calc_features, keyed by their
+  // "Lib:feature;wildcards" name. It is kept by resetTrace and resetData.
+  void setProfiling(bool enabled) { profiling = enabled; }
+  const std::map<string, StepProfile>& getProfile() const { return profile; }
+  void resetProfile() { profile.clear(); }
   double getDistance(string strName, double mean, double std, 
           bool trace_check=true, double error_dist=250);
 
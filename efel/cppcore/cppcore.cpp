@@ -37,8 +37,12 @@
 #include <Python.h>
 
 #include <cstddef>
+#include <cstring>
 #include <cfeature.h>
 #include <efel.h>
+#include <FeatureBatch.h>
+#include <FeatureStream.h>
+#include <TraceGenerator.h>
 
 #if PY_MAJOR_VERSION >= 3
 #define IS_PY3K
@@ -54,8 +58,7 @@ static PyObject* CppCoreInitialize(PyObject* self, PyObject* args) {
     return NULL;
   }
 
-  Initialize(depfilename, outfilename);
-  return Py_BuildValue("");
+  return Py_BuildValue("i", Initialize(depfilename, outfilename));
 }
 
 static vector<int> PyList_to_vectorint(PyObject* input) {
@@ -70,7 +73,8 @@ static vector<int> PyList_to_vectorint(PyObject* input) {
   return result_vector;
 }
 
-static void PyList_from_vectorint(vector<int> input, PyObject* output) {
+static void PyList_from_vectorint(const vector<int>& input,
+                                  PyObject* output) {
   size_t vector_size = input.size();
 
   for (size_t index = 0; index < vector_size; index++) {
@@ -80,19 +84,65 @@ static void PyList_from_vectorint(vector<int> input, PyObject* output) {
   }
 }
 
-static vector<double> PyList_to_vectordouble(PyObject* input) {
-  vector<double> result_vector;
-  int list_size;
-  int index;
+static bool PySequence_to_vectordouble(PyObject* input,
+                                       vector<double>& output) {
+  PyObject* sequence = PySequence_Fast(input, "Values should be a sequence of floats");
+  if (sequence == NULL) {
+    return false;
+  }
+  Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+  PyObject** items = PySequence_Fast_ITEMS(sequence);
+  output.resize(size);
+  for (Py_ssize_t index = 0; index < size; index++) {
+    output[index] = PyFloat_AsDouble(items[index]);
+  }
+  Py_DECREF(sequence);
+  return !PyErr_Occurred();
+}
 
-  list_size = PyList_Size(input);
-  for (index = 0; index < list_size; index++) {
-    result_vector.push_back(PyFloat_AsDouble(PyList_GetItem(input, index)));
+static bool is_double_format(const char* format) {
+  if (format == NULL) {
+    return false;
   }
-  return result_vector;
+  if (format[0] == '@' || format[0] == '=') {
+    format++;
+  }
+  return strcmp(format, "d") == 0;
 }
 
-static void PyList_from_vectordouble(vector<double> input, PyObject* output) {
+// Objects that expose a one-dimensional float64 buffer (e.g. numpy arrays)
+// are read directly from memory, without creating a Python float for every
+// element. Everything else goes through the sequence protocol.
+static bool PyObject_to_vectordouble(PyObject* input, vector<double>& output) {
+  if (PyObject_CheckBuffer(input)) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(input, &view, PyBUF_STRIDES | PyBUF_FORMAT) == 0) {
+      if (view.ndim == 1 && is_double_format(view.format)) {
+        const char* buf = static_cast<const char*>(view.buf);
+        Py_ssize_t size = view.shape[0];
+        Py_ssize_t stride = view.strides[0];
+        if (stride == sizeof(double)) {
+          const double* data = reinterpret_cast<const double*>(buf);
+          output.assign(data, data + size);
+        } else {
+          output.resize(size);
+          for (Py_ssize_t index = 0; index < size; index++) {
+            memcpy(&output[index], buf + index * stride, sizeof(double));
+          }
+        }
+        PyBuffer_Release(&view);
+        return true;
+      }
+      PyBuffer_Release(&view);
+    } else {
+      PyErr_Clear();
+    }
+  }
+  return PySequence_to_vectordouble(input, output);
+}
+
+static void PyList_from_vectordouble(const vector<double>& input,
+                                     PyObject* output) {
   size_t vector_size = input.size();
 
   for (size_t index = 0; index < vector_size; index++) {
@@ -112,6 +162,15 @@ static void PyList_from_vectorstring(vector<string> input, PyObject* output) {
   }
 }
 
+// Copy the values into a bytearray with a single memcpy, numpy.frombuffer
+// turns it into an array without any further copy
+template <typename T>
+static PyObject* PyByteArray_from_vector(const vector<T>& input) {
+  return PyByteArray_FromStringAndSize(
+      reinterpret_cast<const char*>(input.empty() ? NULL : &input[0]),
+      input.size() * sizeof(T));
+}
+
 static PyObject*
 _getfeature(PyObject* self, PyObject* args, const string &type) {
   char* feature_name;
@@ -130,11 +189,11 @@ _getfeature(PyObject* self, PyObject* args, const string &type) {
   }
 
   if (feature_type == "int") {
-    vector<int> values;
+    ConstVecRef<int> values;
     return_value = pFeature->getFeatureInt(string(feature_name), values);
     PyList_from_vectorint(values, py_values);
   } else if (feature_type == "double") {
-    vector<double> values;
+    ConstVecRef<double> values;
     return_value = pFeature->getFeatureDouble(string(feature_name), values);
     PyList_from_vectordouble(values, py_values);
   } else {
@@ -176,6 +235,38 @@ static PyObject* getfeature(PyObject* self, PyObject* args) {
   return _getfeature(self, args, empty);
 }
 
+static PyObject* getfeaturearray(PyObject* self, PyObject* args) {
+  char* feature_name;
+  if (!PyArg_ParseTuple(args, "s", &feature_name)) {
+    return NULL;
+  }
+
+  string feature_type = pFeature->featuretype(string(feature_name));
+
+  int return_value;
+  PyObject* py_values;
+  const char* dtype;
+  if (feature_type == "int") {
+    ConstVecRef<int> values;
+    return_value = pFeature->getFeatureInt(string(feature_name), values);
+    py_values = PyByteArray_from_vector(values.get());
+    dtype = "i";
+  } else if (feature_type == "double") {
+    ConstVecRef<double> values;
+    return_value = pFeature->getFeatureDouble(string(feature_name), values);
+    py_values = PyByteArray_from_vector(values.get());
+    dtype = "d";
+  } else {
+    PyErr_SetString(PyExc_TypeError, "Unknown feature name");
+    return NULL;
+  }
+  if (py_values == NULL) {
+    return NULL;
+  }
+
+  return Py_BuildValue("isN", return_value, dtype, py_values);
+}
+
 static PyObject* setfeatureint(PyObject* self, PyObject* args) {
   char* feature_name;
   PyObject* py_values;
@@ -186,7 +277,8 @@ static PyObject* setfeatureint(PyObject* self, PyObject* args) {
   }
 
   values = PyList_to_vectorint(py_values);
-  return_value = pFeature->setFeatureInt(string(feature_name), values);
+  return_value =
+      pFeature->setFeatureInt(string(feature_name), std::move(values));
 
   return Py_BuildValue("i", return_value);
 }
@@ -209,12 +301,15 @@ static PyObject* setfeaturedouble(PyObject* self, PyObject* args) {
   PyObject* py_values;
   vector<double> values;
   int return_value;
-  if (!PyArg_ParseTuple(args, "sO!", &feature_name, &PyList_Type, &py_values)) {
+  if (!PyArg_ParseTuple(args, "sO", &feature_name, &py_values)) {
     return NULL;
   }
 
-  values = PyList_to_vectordouble(py_values);
-  return_value = pFeature->setFeatureDouble(string(feature_name), values);
+  if (!PyObject_to_vectordouble(py_values, values)) {
+    return NULL;
+  }
+  return_value =
+      pFeature->setFeatureDouble(string(feature_name), std::move(values));
 
   return Py_BuildValue("f", return_value);
 }
@@ -261,6 +356,286 @@ static PyObject* getDistance_wrapper(PyObject* self,
   return Py_BuildValue("d", distance);
 }
 
+static bool PyString_to_string(PyObject* input, string& output) {
+#ifdef IS_PY3K
+  const char* value = PyUnicode_AsUTF8(input);
+#else
+  const char* value = PyString_AsString(input);
+#endif
+  if (value == NULL) {
+    return false;
+  }
+  output = value;
+  return true;
+}
+
+static PyObject* getFeatureValuesBatch(PyObject* self, PyObject* args) {
+  char* depfilename;
+  PyObject* py_traces, *py_feature_names;
+  PyObject* py_int_settings, *py_double_settings;
+  int n_threads = 0;
+  if (!PyArg_ParseTuple(args, "sO!O!O!O!|i", &depfilename,
+                        &PyList_Type, &py_traces,
+                        &PyList_Type, &py_feature_names,
+                        &PyDict_Type, &py_int_settings,
+                        &PyDict_Type, &py_double_settings, &n_threads)) {
+    return NULL;
+  }
+  if (n_threads < 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "The number of threads can not be negative");
+    return NULL;
+  }
+
+  BatchJob job;
+  job.depFile = depfilename;
+
+  Py_ssize_t pos = 0;
+  PyObject* key, *value;
+  string name;
+  while (PyDict_Next(py_int_settings, &pos, &key, &value)) {
+    if (!PyString_to_string(key, name)) return NULL;
+    job.intSettings[name] = vector<int>(1, PyLong_AsLong(value));
+  }
+  pos = 0;
+  while (PyDict_Next(py_double_settings, &pos, &key, &value)) {
+    if (!PyString_to_string(key, name)) return NULL;
+    job.doubleSettings[name] = vector<double>(1, PyFloat_AsDouble(value));
+  }
+  if (PyErr_Occurred()) return NULL;
+
+  Py_ssize_t n_features = PyList_Size(py_feature_names);
+  job.featureNames.resize(n_features);
+  for (Py_ssize_t index = 0; index < n_features; index++) {
+    if (!PyString_to_string(PyList_GetItem(py_feature_names, index),
+                            job.featureNames[index])) {
+      return NULL;
+    }
+  }
+
+  Py_ssize_t n_traces = PyList_Size(py_traces);
+  job.traces.resize(n_traces);
+  for (Py_ssize_t index = 0; index < n_traces; index++) {
+    PyObject* py_trace = PyList_GetItem(py_traces, index);
+    if (!PyDict_Check(py_trace)) {
+      PyErr_SetString(PyExc_TypeError, "Every trace should be a dict");
+      return NULL;
+    }
+    pos = 0;
+    while (PyDict_Next(py_trace, &pos, &key, &value)) {
+      if (!PyString_to_string(key, name) ||
+          !PyObject_to_vectordouble(value, job.traces[index][name])) {
+        return NULL;
+      }
+    }
+  }
+
+  vector<vector<BatchFeatureResult> > results;
+  BatchErrors errors;
+  string error;
+  int return_value;
+  Py_BEGIN_ALLOW_THREADS
+  return_value = calcFeatureBatch(job, n_threads, results, errors, error);
+  Py_END_ALLOW_THREADS
+  if (return_value < 0) {
+    PyErr_SetString(PyExc_ValueError, error.c_str());
+    return NULL;
+  }
+
+  // Returns a tuple with for every trace a dict with the feature values
+  // (None on failure), the errors as a list of (trace index, feature index,
+  // error code, message index) tuples and the list of messages, see
+  // BatchErrors. The values are (dtype, bytearray) tuples like in
+  // getFeatureArray
+  PyObject* py_results = PyList_New(n_traces);
+  for (Py_ssize_t index = 0; index < n_traces; index++) {
+    PyObject* py_values = PyDict_New();
+    for (Py_ssize_t feature = 0; feature < n_features; feature++) {
+      const BatchFeatureResult& result = results[index][feature];
+      const char* feature_name = job.featureNames[feature].c_str();
+      if (result.retval < 0) {
+        PyDict_SetItemString(py_values, feature_name, Py_None);
+      } else {
+        PyObject* py_feature_values;
+        if (result.type == "int") {
+          py_feature_values = Py_BuildValue(
+              "sN", "i", PyByteArray_from_vector(result.intValues));
+        } else {
+          py_feature_values = Py_BuildValue(
+              "sN", "d", PyByteArray_from_vector(result.doubleValues));
+        }
+        PyDict_SetItemString(py_values, feature_name, py_feature_values);
+        Py_DECREF(py_feature_values);
+      }
+    }
+    PyList_SET_ITEM(py_results, index, py_values);
+  }
+
+  PyObject* py_errors = PyList_New(errors.records.size());
+  for (size_t index = 0; index < errors.records.size(); index++) {
+    const BatchError& record = errors.records[index];
+    PyList_SET_ITEM(py_errors, index,
+                    Py_BuildValue("IIii", record.trace, record.feature,
+                                  record.code, record.message));
+  }
+  PyObject* py_messages = PyList_New(errors.messages.size());
+  for (size_t index = 0; index < errors.messages.size(); index++) {
+    PyList_SET_ITEM(py_messages, index,
+                    Py_BuildValue("s", errors.messages[index].c_str()));
+  }
+
+  return Py_BuildValue("NNN", py_results, py_errors, py_messages);
+}
+
+static const char* const STREAM_CAPSULE = "efel.cppcore.FeatureStream";
+
+static void deleteStream(PyObject* py_stream) {
+  delete static_cast<FeatureStream*>(
+      PyCapsule_GetPointer(py_stream, STREAM_CAPSULE));
+}
+
+static PyObject* streamOpen(PyObject* self, PyObject* args) {
+  PyObject* py_settings;
+  if (!PyArg_ParseTuple(args, "O!", &PyDict_Type, &py_settings)) {
+    return NULL;
+  }
+
+  mapStr2doubleVec settings;
+  Py_ssize_t pos = 0;
+  PyObject* key, *value;
+  string name;
+  while (PyDict_Next(py_settings, &pos, &key, &value)) {
+    if (!PyString_to_string(key, name)) return NULL;
+    settings[name] = vector<double>(1, PyFloat_AsDouble(value));
+  }
+  if (PyErr_Occurred()) return NULL;
+
+  return PyCapsule_New(new FeatureStream(settings), STREAM_CAPSULE,
+                       deleteStream);
+}
+
+// The values found since the previous call, as a dict with (dtype, bytearray)
+// tuples like in getFeatureArray. Spikecount is the number of peaks so far.
+static PyObject* streamValues(FeatureStream* stream) {
+  StreamValues values;
+  stream->takeValues(values);
+
+  PyObject* py_values = PyDict_New();
+  const vector<int> spikecount(1, stream->spikeCount());
+  const std::pair<const char*, const vector<int>*> int_values[] = {
+      std::make_pair("peak_indices", &values.peak_indices),
+      std::make_pair("min_AHP_indices", &values.min_AHP_indices),
+      std::make_pair("Spikecount", &spikecount)};
+  const std::pair<const char*, const vector<double>*> double_values[] = {
+      std::make_pair("peak_time", &values.peak_time),
+      std::make_pair("peak_voltage", &values.peak_voltage),
+      std::make_pair("all_ISI_values", &values.all_ISI_values),
+      std::make_pair("min_AHP_values", &values.min_AHP_values),
+      std::make_pair("voltage_base", &values.voltage_base)};
+  for (size_t i = 0; i < sizeof(int_values) / sizeof(int_values[0]); i++) {
+    PyObject* py_feature_values = Py_BuildValue(
+        "sN", "i", PyByteArray_from_vector(*int_values[i].second));
+    PyDict_SetItemString(py_values, int_values[i].first, py_feature_values);
+    Py_DECREF(py_feature_values);
+  }
+  for (size_t i = 0; i < sizeof(double_values) / sizeof(double_values[0]);
+       i++) {
+    PyObject* py_feature_values = Py_BuildValue(
+        "sN", "d", PyByteArray_from_vector(*double_values[i].second));
+    PyDict_SetItemString(py_values, double_values[i].first, py_feature_values);
+    Py_DECREF(py_feature_values);
+  }
+  return py_values;
+}
+
+static PyObject* streamPush(PyObject* self, PyObject* args) {
+  PyObject* py_stream, *py_time, *py_voltage;
+  if (!PyArg_ParseTuple(args, "OOO", &py_stream, &py_time, &py_voltage)) {
+    return NULL;
+  }
+  FeatureStream* stream = static_cast<FeatureStream*>(
+      PyCapsule_GetPointer(py_stream, STREAM_CAPSULE));
+  if (stream == NULL) return NULL;
+
+  vector<double> time, voltage;
+  if (!PyObject_to_vectordouble(py_time, time) ||
+      !PyObject_to_vectordouble(py_voltage, voltage)) {
+    return NULL;
+  }
+  if (time.size() != voltage.size()) {
+    PyErr_SetString(PyExc_ValueError,
+                    "Time and voltage should have the same length");
+    return NULL;
+  }
+
+  string error;
+  if (stream->push(time.empty() ? NULL : &time[0],
+                   voltage.empty() ? NULL : &voltage[0], time.size(),
+                   error) < 0) {
+    PyErr_SetString(PyExc_ValueError, error.c_str());
+    return NULL;
+  }
+  return streamValues(stream);
+}
+
+static PyObject* streamFinish(PyObject* self, PyObject* args) {
+  PyObject* py_stream;
+  if (!PyArg_ParseTuple(args, "O", &py_stream)) {
+    return NULL;
+  }
+  FeatureStream* stream = static_cast<FeatureStream*>(
+      PyCapsule_GetPointer(py_stream, STREAM_CAPSULE));
+  if (stream == NULL) return NULL;
+
+  string error;
+  if (stream->finish(error) < 0) {
+    PyErr_SetString(PyExc_ValueError, error.c_str());
+    return NULL;
+  }
+  return streamValues(stream);
+}
+
+// Samples [first, first + count) of a synthetic trace, as a dict with
+// (dtype, bytearray) tuples for T, V and spike_times (of the whole trace)
+// and stim_start and stim_end
+static PyObject* generateTrace(PyObject* self, PyObject* args) {
+  PyObject* py_settings;
+  Py_ssize_t first = 0, count = -1;
+  if (!PyArg_ParseTuple(args, "O!|nn", &PyDict_Type, &py_settings, &first,
+                        &count)) {
+    return NULL;
+  }
+
+  mapStr2doubleVec settings;
+  Py_ssize_t pos = 0;
+  PyObject* key, *value;
+  string name;
+  while (PyDict_Next(py_settings, &pos, &key, &value)) {
+    if (!PyString_to_string(key, name)) return NULL;
+    settings[name] = vector<double>(1, PyFloat_AsDouble(value));
+  }
+  if (PyErr_Occurred()) return NULL;
+
+  SyntheticTrace trace;
+  string error;
+  if (trace.init(settings, error) < 0 || first < 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    first < 0 ? "first can not be negative" : error.c_str());
+    return NULL;
+  }
+  vector<double> t, v;
+  Py_BEGIN_ALLOW_THREADS
+  trace.generate(first, count < 0 ? trace.size() : count, t, v);
+  Py_END_ALLOW_THREADS
+
+  return Py_BuildValue("{s:(sN),s:(sN),s:(sN),s:d,s:d}", "T", "d",
+                       PyByteArray_from_vector(t), "V", "d",
+                       PyByteArray_from_vector(v), "spike_times", "d",
+                       PyByteArray_from_vector(trace.spikeTimes()),
+                       "stim_start", trace.stimStart(), "stim_end",
+                       trace.stimEnd());
+}
+
 static PyObject* featuretype(PyObject* self, PyObject* args) {
   char* feature_name;
   string feature_type;
@@ -274,16 +649,123 @@ static PyObject* featuretype(PyObject* self, PyObject* args) {
   return Py_BuildValue("s", feature_type.c_str());
 }
 
+static PyObject* setsettingint(PyObject* self, PyObject* args) {
+  char* setting_name;
+  PyObject* py_values;
+  int return_value;
+  if (!PyArg_ParseTuple(args, "sO!", &setting_name, &PyList_Type,
+                        &py_values)) {
+    return NULL;
+  }
+
+  return_value = pFeature->setSettingInt(string(setting_name),
+                                         PyList_to_vectorint(py_values));
+
+  return Py_BuildValue("i", return_value);
+}
+
+static PyObject* setsettingdouble(PyObject* self, PyObject* args) {
+  char* setting_name;
+  PyObject* py_values;
+  vector<double> values;
+  int return_value;
+  if (!PyArg_ParseTuple(args, "sO", &setting_name, &py_values)) {
+    return NULL;
+  }
+
+  if (!PyObject_to_vectordouble(py_values, values)) {
+    return NULL;
+  }
+  return_value =
+      pFeature->setSettingDouble(string(setting_name), std::move(values));
+
+  return Py_BuildValue("i", return_value);
+}
+
+static PyObject* resettrace(PyObject* self, PyObject* args) {
+  return Py_BuildValue("i", resetTrace());
+}
+
+static PyObject* settracefile(PyObject* self, PyObject* args) {
+  char* path;
+  if (!PyArg_ParseTuple(args, "s", &path)) {
+    return NULL;
+  }
+  return Py_BuildValue("i", setTraceFile(path));
+}
+
 static PyObject* getgerrorstr(PyObject* self, PyObject* args) {
   return Py_BuildValue("s", pFeature->getGError().c_str());
 }
 
+static PyObject* setprofiling(PyObject* self, PyObject* args) {
+  PyObject* enabled;
+  if (!PyArg_ParseTuple(args, "O", &enabled)) {
+    return NULL;
+  }
+  int is_enabled = PyObject_IsTrue(enabled);
+  if (is_enabled < 0) {
+    return NULL;
+  }
+  pFeature->setProfiling(is_enabled != 0);
+  return Py_BuildValue("");
+}
+
+static PyObject* getprofile(PyObject* self, PyObject* args) {
+  const std::map<string, StepProfile>& profile = pFeature->getProfile();
+  PyObject* py_profile = PyDict_New();
+  if (py_profile == NULL) {
+    return NULL;
+  }
+  for (std::map<string, StepProfile>::const_iterator it = profile.begin();
+       it != profile.end(); ++it) {
+    const StepProfile& step = it->second;
+    PyObject* py_step = Py_BuildValue(
+        "{s:n,s:n,s:d,s:n}", "calls", static_cast<Py_ssize_t>(step.calls),
+        "cache_hits", static_cast<Py_ssize_t>(step.cacheHits), "time",
+        step.seconds, "output_size", static_cast<Py_ssize_t>(step.outputSize));
+    if (py_step == NULL ||
+        PyDict_SetItemString(py_profile, it->first.c_str(), py_step) < 0) {
+      Py_XDECREF(py_step);
+      Py_DECREF(py_profile);
+      return NULL;
+    }
+    Py_DECREF(py_step);
+  }
+  return py_profile;
+}
+
+static PyObject* resetprofile(PyObject* self, PyObject* args) {
+  pFeature->resetProfile();
+  return Py_BuildValue("");
+}
+
+static PyObject* setloglevel(PyObject* self, PyObject* args) {
+  int level;
+  if (!PyArg_ParseTuple(args, "i", &level)) {
+    return NULL;
+  }
+  eFELLogger::setLevel(level);
+  return Py_BuildValue("");
+}
+
+static PyObject* flushlog(PyObject* self, PyObject* args) {
+  if (pFeature != NULL) {
+    Py_BEGIN_ALLOW_THREADS
+    pFeature->logger.flush();
+    Py_END_ALLOW_THREADS
+  }
+  return Py_BuildValue("");
+}
+
 static PyMethodDef CppCoreMethods[] = {
     {"Initialize", CppCoreInitialize, METH_VARARGS,
-      "Initialise CppCore."},
+      "Initialise CppCore. Returns the number of this initialisation."},
 
     {"getFeature", getfeature, METH_VARARGS,
       "Get a values associated with a feature. Takes a list() to be filled."},
+    {"getFeatureArray", getfeaturearray, METH_VARARGS,
+      "Get the values of a feature as a tuple (exit code, dtype, bytearray)."},
     {"getFeatureInt", getfeatureint, METH_VARARGS,
       "Get a integer feature."},
     {"getFeatureDouble", getfeaturedouble, METH_VARARGS,
@@ -297,6 +779,17 @@ static PyMethodDef CppCoreMethods[] = {
       "Set a integer feature."},
     {"setFeatureDouble", setfeaturedouble, METH_VARARGS,
       "Set a double feature."},
+    {"setSettingInt", setsettingint, METH_VARARGS,
+      "Set a integer setting, settings are kept by resetTrace."},
+    {"setSettingDouble", setsettingdouble, METH_VARARGS,
+      "Set a double setting, settings are kept by resetTrace."},
+    {"resetTrace", resettrace, METH_NOARGS,
+      "Drop the data of the current trace but keep the settings. Returns "
+      "the number of the initialisation that made the settings, 0 if "
+      "cppcore has to be initialised again."},
+    {"setTraceFile", settracefile, METH_VARARGS,
+      "Use the trace in a binary trace file as T and V, see "
+      "efel.io.write_trace_file. Returns -1 if the file can't be used."},
 
     {"featuretype", featuretype, METH_VARARGS,
       "Get the type of a feature"},
@@ -305,8 +798,32 @@ static PyMethodDef CppCoreMethods[] = {
     {"getFeatureNames", getFeatureNames, METH_VARARGS,
       "Get the names of all the available features"},
 
+    {"setProfiling", setprofiling, METH_VARARGS,
+      "Enable or disable the profiling of the feature calculations"},
+    {"getProfile", getprofile, METH_NOARGS,
+      "Get the profile as a dict of step name -> dict with the calls, "
+      "cache_hits, time (s) and output_size of the step"},
+    {"resetProfile", resetprofile, METH_NOARGS,
+      "Drop the collected profile"},
+
+    {"setLogLevel", setloglevel, METH_VARARGS,
+      "Set the minimum level of the logged messages: 0 debug, 1 info, "
+      "2 warning, 3 error, 4 off"},
+    {"flushLog", flushlog, METH_NOARGS,
+      "Wait until the messages of the log are written to fllog.txt"},
+
     {"getDistance", (PyCFunction)getDistance_wrapper, METH_VARARGS|METH_KEYWORDS,
       "Get the distance between a feature and experimental data"},
+    {"getFeatureValuesBatch", getFeatureValuesBatch, METH_VARARGS,
+      "Calculate features on a list of traces using a pool of threads"},
+    {"streamOpen", streamOpen, METH_VARARGS,
+      "Create a stream of spike features with the given double settings"},
+    {"streamPush", streamPush, METH_VARARGS,
+      "Push time and voltage samples into a stream, returns the new values"},
+    {"streamFinish", streamFinish, METH_VARARGS,
+      "End the trace of a stream, returns the last values"},
+    {"generateTrace", generateTrace, METH_VARARGS,
+      "Generate the samples of a synthetic trace with the given settings"},
     {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
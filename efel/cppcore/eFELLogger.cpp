@@ -0,0 +1,185 @@
+/* Copyright (c) 2015, EPFL/Blue Brain Project
+ *
+ * This file is part of eFEL <https://github.com/BlueBrain/eFEL>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "eFELLogger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+static std::atomic<int> logLevel(EFEL_LOG_DEBUG);
+
+/*
+ * The file and the thread that writes it. The ring buffer has a single
+ * producer, the thread of the engine (an engine is not shared between
+ * threads), and a single consumer, the writer thread, so that write() only
+ * needs atomic loads and stores.
+ */
+class eFELLogger::Writer {
+ public:
+  explicit Writer(const std::string& filename);
+  ~Writer();
+  void write(std::string& message);
+  void flush();
+
+ private:
+  void run();
+  void drain();
+
+  static const size_t capacity = 4096;
+  std::ofstream file;
+  std::vector<std::string> ring;
+  // messages [tail, head) are waiting to be written
+  std::atomic<size_t> head, tail;
+  std::atomic<size_t> dropped;
+  std::mutex mutex;
+  std::condition_variable wake, drained;
+  bool stop;
+  std::thread thread;
+};
+
+// The writers of the loggers that exist, to write their messages at exit
+static std::mutex& writersMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::set<eFELLogger::Writer*>& writers() {
+  static std::set<eFELLogger::Writer*> writers;
+  return writers;
+}
+
+static void flushAtExit() {
+  std::lock_guard<std::mutex> lock(writersMutex());
+  for (std::set<eFELLogger::Writer*>::iterator it = writers().begin();
+       it != writers().end(); ++it) {
+    (*it)->flush();
+  }
+}
+
+eFELLogger::Writer::Writer(const std::string& filename)
+    : file(filename.c_str(), std::ofstream::out | std::ofstream::app),
+      ring(capacity),
+      head(0),
+      tail(0),
+      dropped(0),
+      stop(false) {
+  thread = std::thread(&Writer::run, this);
+
+  std::lock_guard<std::mutex> lock(writersMutex());
+  // registered after the set is constructed, so it runs before the set is
+  // destroyed
+  static const int registered = std::atexit(flushAtExit);
+  (void)registered;
+  writers().insert(this);
+}
+
+eFELLogger::Writer::~Writer() {
+  {
+    std::lock_guard<std::mutex> lock(writersMutex());
+    writers().erase(this);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+void eFELLogger::Writer::write(std::string& message) {
+  const size_t h = head.load(std::memory_order_relaxed);
+  if (h - tail.load(std::memory_order_acquire) >= capacity) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ring[h % capacity].swap(message);
+  head.store(h + 1, std::memory_order_release);
+  // without the mutex a wake up can be missed, the writer then finds the
+  // message when its wait times out
+  wake.notify_one();
+}
+
+void eFELLogger::Writer::flush() {
+  const size_t h = head.load(std::memory_order_acquire);
+  std::unique_lock<std::mutex> lock(mutex);
+  wake.notify_one();
+  while (tail.load(std::memory_order_acquire) < h) {
+    drained.wait(lock);
+  }
+}
+
+void eFELLogger::Writer::drain() {
+  size_t t = tail.load(std::memory_order_relaxed);
+  const size_t h = head.load(std::memory_order_acquire);
+  if (t == h) return;
+  for (; t != h; t++) {
+    std::string& message = ring[t % capacity];
+    file << message;
+    std::string().swap(message);
+    tail.store(t + 1, std::memory_order_release);
+  }
+  const size_t lost = dropped.exchange(0, std::memory_order_relaxed);
+  if (lost > 0) {
+    file << "[" << lost << " log messages dropped]\n";
+  }
+  file.flush();
+}
+
+void eFELLogger::Writer::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    lock.unlock();
+    drain();
+    lock.lock();
+    drained.notify_all();
+    const bool empty = tail.load(std::memory_order_acquire) ==
+                       head.load(std::memory_order_acquire);
+    if (stop && empty) break;
+    if (empty) wake.wait_for(lock, std::chrono::milliseconds(50));
+  }
+}
+
+eFELLogger::eFELLogger(const std::string& outdir) {
+  if (!outdir.empty()) {
+    writer.reset(new Writer(outdir + "/fllog.txt"));
+  }
+}
+
+eFELLogger::~eFELLogger() {}
+
+void eFELLogger::setLevel(int level) {
+  logLevel.store(level, std::memory_order_relaxed);
+}
+
+int eFELLogger::getLevel() {
+  return logLevel.load(std::memory_order_relaxed);
+}
+
+void eFELLogger::flush() {
+  if (writer) writer->flush();
+}
+
+void eFELLogger::write(std::string message) {
+  if (writer) writer->write(message);
+}
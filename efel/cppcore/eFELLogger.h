@@ -16,60 +16,117 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-
 #ifndef EFELLOGGER_H
 #define EFELLOGGER_H
 
-#include <iostream>
-#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <vector>
 
-class eFELLogger
-{
-public:
-  eFELLogger(const string &outdir)
-    : logging(false)
-  {
-    if (!outdir.empty()) {
-      string filename = outdir + "/fllog.txt";
-      logfile.open(filename.c_str(), std::fstream::out | std::fstream::app);
-      logging = true;
-    }
+// Severity of a log message, messages below the level set with
+// eFELLogger::setLevel are skipped
+enum eFELLogLevel {
+  EFEL_LOG_DEBUG = 0,
+  EFEL_LOG_INFO = 1,
+  EFEL_LOG_WARNING = 2,
+  EFEL_LOG_ERROR = 3,
+  EFEL_LOG_OFF = 4
+};
+
+/*
+ * Log of an engine in outdir/fllog.txt, no log if outdir is empty. Messages
+ * are written with
+ *
+ *   EFEL_LOG(logger, EFEL_LOG_DEBUG) << "Set " << name << ":" << values;
+ *
+ * which doesn't evaluate or format anything unless the logger is enabled
+ * for the level, and compiles to nothing if EFEL_NO_LOGGING is defined.
+ * A formatted message is handed to a thread that writes the file, through
+ * a ring buffer, so logging doesn't wait for the disk. Messages are dropped
+ * (and their number is logged) if the buffer is full. The messages still in
+ * the buffer are written by flush(), when the logger is destroyed and when
+ * the program exits.
+ */
+class eFELLogger {
+ public:
+  explicit eFELLogger(const std::string& outdir);
+  ~eFELLogger();
+
+  // The level of all the loggers, EFEL_LOG_DEBUG by default
+  static void setLevel(int level);
+  static int getLevel();
+
+  bool enabled(int level) const {
+    return writer && level >= getLevel();
   }
+  // Wait until all the messages are written
+  void flush();
 
-  template<typename T>
-  eFELLogger &operator<<(const std::vector<T> &v){
-    if(logging){
+  // A message, it is sent to the writer when the line is destroyed at the
+  // end of the statement
+  class Line {
+   public:
+    explicit Line(eFELLogger& logger) : logger(logger), active(true) {}
+    Line(Line&& other)
+        : logger(other.logger),
+          stream(std::move(other.stream)),
+          active(other.active) {
+      other.active = false;
+    }
+    ~Line() {
+      if (!active) return;
+      stream << '\n';
+      logger.write(stream.str());
+    }
+
+    template <typename T>
+    Line& operator<<(const std::vector<T>& v) {
       const size_t max = 10;
       for (size_t i = 0; i < v.size() && i < max; i++) {
-        logfile << " " << v[i];
+        stream << " " << v[i];
       }
       if (v.size() > max) {
-        logfile << " ...";
+        stream << " ...";
       }
+      return *this;
     }
-    return *this;
-  }
 
-  template<typename T>
-  eFELLogger &operator<<(const T value){
-    if(logging){
-      logfile << value;
+    template <typename T>
+    Line& operator<<(const T& value) {
+      stream << value;
+      return *this;
     }
-    return *this;
-  }
 
-  // deal with std::endl
-  eFELLogger &operator <<(std::ostream& (*os)(std::ostream&)){
-    if(logging){
-      logfile << os;
-    }
-    return *this;
-  }
+   private:
+    eFELLogger& logger;
+    std::ostringstream stream;
+    bool active;
+  };
+  Line line() { return Line(*this); }
 
-private:
-  bool logging;
-  std::fstream logfile;
+  // The file and its thread, defined in eFELLogger.cpp
+  class Writer;
+
+ private:
+  eFELLogger(const eFELLogger&);
+  eFELLogger& operator=(const eFELLogger&);
+
+  void write(std::string message);
+
+  std::unique_ptr<Writer> writer;
 };
 
+#ifdef EFEL_NO_LOGGING
+#define EFEL_LOG(logger, level) \
+  if (true) {                   \
+  } else                        \
+    (logger).line()
+#else
+#define EFEL_LOG(logger, level)       \
+  if (!(logger).enabled(level)) {     \
+  } else                              \
+    (logger).line()
+#endif
+
 #endif
@@ -21,17 +21,37 @@
 #include "cfeature.h"
 
 cFeature *pFeature = NULL;
+static string pFeatureDepFile;
+static string pFeatureOutdir;
+// Counts the calls of Initialize, every call drops the settings
+static int pFeatureGeneration = 0;
 
+static int nextGeneration() {
+  if (++pFeatureGeneration <= 0) pFeatureGeneration = 1;
+  return pFeatureGeneration;
+}
+
+// Returns the number of this call, which resetTrace returns until the next one
 int Initialize(const char *strDepFile, const char *outdir) {
+  // Initializing again with the same, unmodified dependency file and log
+  // directory only drops the data of the previous trace
+  if (pFeature != NULL && pFeatureOutdir == outdir &&
+      pFeature->usesDependencyFile(strDepFile)) {
+    pFeature->resetData(strDepFile);
+    return nextGeneration();
+  }
+
   if (pFeature != NULL) {
     delete pFeature;
   }
 
+  pFeatureDepFile = strDepFile;
+  pFeatureOutdir = outdir;
   pFeature = new cFeature(string(strDepFile), string(outdir));
   if (pFeature == NULL) {
     return -1;
   } else {
-    return 1;
+    return nextGeneration();
   }
 }
 
@@ -48,7 +68,7 @@ int setFeatureInt(const char *strName, int *A, unsigned nValue) {
   for (unsigned i = 0; i < nValue; i++) {
     v[i] = A[i];
   }
-  pFeature->setFeatureInt(string(strName), v);
+  pFeature->setFeatureInt(string(strName), std::move(v));
   return 1;
 }
 
@@ -60,34 +80,56 @@ int setFeatureDouble(const char *strName, double *A, unsigned nValue) {
     v[i] = A[i];
   }
   // mapDoubleData.insert(pair<string, vector< double > > (string(strName), v));
-  pFeature->setFeatureDouble(string(strName), v);
+  pFeature->setFeatureDouble(string(strName), std::move(v));
   // printf("\nInside featureLibrary.. After setdouble [%s = %f]\n", strName,
   // A[0]);
   return 1;
 }
 
+int setSettingInt(const char *strName, int *A, unsigned nValue) {
+  return pFeature->setSettingInt(string(strName), vector<int>(A, A + nValue));
+}
+
+int setSettingDouble(const char *strName, double *A, unsigned nValue) {
+  return pFeature->setSettingDouble(string(strName),
+                                    vector<double>(A, A + nValue));
+}
+
+// Returns the number of the Initialize call whose settings are kept for the
+// new trace, 0 if there is no engine or if its dependency file was modified
+// and it has to be initialized again
+int resetTrace() {
+  if (pFeature == NULL || !pFeature->usesDependencyFile(pFeatureDepFile)) {
+    return 0;
+  }
+  pFeature->resetTrace();
+  return pFeatureGeneration;
+}
+
+// The samples of the trace file are read from a mapping of the file instead
+// of being copied, see cFeature::setTraceFile
+int setTraceFile(const char *strPath) {
+  return pFeature->setTraceFile(string(strPath));
+}
+
 int getFeatureInt(const char *strName, int **A) {
-  vector<int> vec;
+  ConstVecRef<int> vec;
   if (pFeature->getFeatureInt(string(strName), vec) < 0) {
     return -1;
   }
   *A = new int[vec.size()];
-  for (unsigned i = 0; i < vec.size(); i++) {
-    (*A)[i] = vec[i];
-  }
+  copy(vec.begin(), vec.end(), *A);
   return vec.size();
 }
 
 int getFeatureDouble(const char *strName, double **A) {
-  vector<double> vec;
+  ConstVecRef<double> vec;
   // printf("\nInside featureLibrary.. Before getdouble [%s ]\n", strName);
   if (pFeature->getFeatureDouble(string(strName), vec) < 0) {
     return -1;
   }
   *A = new double[vec.size()];
-  for (unsigned i = 0; i < vec.size(); i++) {
-    (*A)[i] = vec[i];
-  }
+  copy(vec.begin(), vec.end(), *A);
   // printf("\nInside featureLibrary.. After getdouble [%s= %f ]\n", strName,
   // (*A)[0]);
   return vec.size();
@@ -124,3 +166,14 @@ int printFptr() {
   printf("\n size of fptrlookup %d", (int)pFeature->fptrlookup.size());
   return 1;
 }
+
+// Minimum eFELLogLevel of the messages written to fllog.txt, EFEL_LOG_OFF
+// disables the log
+void setLogLevel(int level) {
+  eFELLogger::setLevel(level);
+}
+
+// The log is written by a background thread, wait until it's up to date
+void flushLog() {
+  if (pFeature != NULL) pFeature->logger.flush();
+}
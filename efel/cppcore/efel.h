@@ -24,6 +24,10 @@ FEATURELIB_API int Initialize(const char *strDepFile, const char *outdir);
 FEATURELIB_API int setVersion(const char *strDepFile);
 FEATURELIB_API int setFeatureInt(const char *strName, int *A, unsigned nValue);
 FEATURELIB_API int setFeatureDouble(const char *strName, double *A, unsigned nValue);
+FEATURELIB_API int setSettingInt(const char *strName, int *A, unsigned nValue);
+FEATURELIB_API int setSettingDouble(const char *strName, double *A, unsigned nValue);
+FEATURELIB_API int resetTrace();
+FEATURELIB_API int setTraceFile(const char *strPath);
 FEATURELIB_API int getTotalIntData();
 FEATURELIB_API int getTotalDoubleData();
 FEATURELIB_API int FeaturePrint(const char *strName);
@@ -34,5 +38,7 @@ FEATURELIB_API int getFeatureString(const char *key, char **value);
 FEATURELIB_API int printFptr();
 FEATURELIB_API char *getgError();
 FEATURELIB_API double getDistance(const char *strName, double mean, double std, bool trace_check);
+FEATURELIB_API void setLogLevel(int level);
+FEATURELIB_API void flushLog();
 }
 #endif
@@ -17,9 +17,38 @@
  */
 
 #include "mapoperations.h"
+#include "Utils.h"
 #include <math.h>
 
-extern string GErrorStr;
+#include <algorithm>
+
+extern thread_local string GErrorStr;
+thread_local size_t GCacheHits = 0;
+thread_local int GErrorCode = EFEL_ERROR_NONE;
+thread_local bool GErrorMessages = true;
+
+bool reportError(int code) {
+  if (GErrorCode == EFEL_ERROR_NONE) GErrorCode = code;
+  return GErrorMessages;
+}
+
+const char* errorCodeDescription(int code) {
+  switch (code) {
+    case EFEL_ERROR_NONE:
+      return "No error";
+    case EFEL_ERROR_FEATURE_FAILED:
+      return "The feature could not be calculated";
+    case EFEL_ERROR_MISSING_PARAMETER:
+      return "A parameter is missing";
+    case EFEL_ERROR_MISSING_FEATURE:
+      return "A feature that is needed could not be calculated";
+    case EFEL_ERROR_UNKNOWN_FEATURE:
+      return "The feature is not in the dependency file";
+    case EFEL_ERROR_INVALID_TRACE:
+      return "T and V are not a valid trace";
+  }
+  return "Unknown error";
+}
 
 /*
  * get(Int|Double|Str)Param provides access to the Int, Double, Str map
@@ -29,9 +58,11 @@ int getIntParam(mapStr2intVec& IntFeatureData, const string& param,
                 vector<int>& vec) {
   mapStr2intVec::iterator mapstr2IntItr(IntFeatureData.find(param));
   if (mapstr2IntItr == IntFeatureData.end()) {
-    GErrorStr += "Parameter [" + param + "] is missing in int map."
-                 "In the python interface this can be set using the "
-                 "setIntSetting() function\n";
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "Parameter [" + param + "] is missing in int map."
+                   "In the python interface this can be set using the "
+                   "setIntSetting() function\n";
+    }
     return -1;
   }
   vec = mapstr2IntItr->second;
@@ -43,40 +74,72 @@ int getDoubleParam(mapStr2doubleVec& DoubleFeatureData, const string& param,
   mapStr2doubleVec::iterator mapstr2DoubleItr;
   mapstr2DoubleItr = DoubleFeatureData.find(param);
   if (mapstr2DoubleItr == DoubleFeatureData.end()) {
-    GErrorStr += "Parameter [" + param +
-                 "] is missing in double map. "
-                 "In the python interface this can be set using the "
-                 "setDoubleSetting() function\n";
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "Parameter [" + param +
+                   "] is missing in double map. "
+                   "In the python interface this can be set using the "
+                   "setDoubleSetting() function\n";
+    }
     return -1;
   }
   vec = mapstr2DoubleItr->second;
   return (vec.size());
 }
 
+int getDoubleParam(mapStr2doubleVec& DoubleFeatureData, const string& param,
+                   ConstVecRef<double>& vec) {
+  mapStr2doubleVec::const_iterator mapstr2DoubleItr(
+      DoubleFeatureData.find(param));
+  if (mapstr2DoubleItr == DoubleFeatureData.end()) {
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "Parameter [" + param +
+                   "] is missing in double map. "
+                   "In the python interface this can be set using the "
+                   "setDoubleSetting() function\n";
+    }
+    return -1;
+  }
+  vec.bind(mapstr2DoubleItr->second);
+  return (vec.size());
+}
+
 int getStrParam(mapStr2Str& StringData, const string& param, string& value) {
   mapStr2Str::const_iterator map_it(StringData.find(param));
   if (map_it == StringData.end()) {
-    GErrorStr += "Parameter [" + param + "] is missing in string map\n";
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "Parameter [" + param + "] is missing in string map\n";
+    }
     return -1;
   }
   value = map_it->second;
   return 1;
 }
 
+// Append the "params" entry of the string map (the trace wildcards of
+// non-elementary features) to a feature name, to get its key in the maps
+static void appendParams(const mapStr2Str& StringData, string& key) {
+  static const string params("params");
+  mapStr2Str::const_iterator map_it(StringData.find(params));
+  if (map_it == StringData.end()) {
+    if (reportError(EFEL_ERROR_MISSING_PARAMETER)) {
+      GErrorStr += "Parameter [params] is missing in string map\n";
+    }
+    return;
+  }
+  key += map_it->second;
+}
+
 void setIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
-               string key, const vector<int>& value) {
-  string params;
-  getStrParam(StringData, "params", params);
-  key += params;
-  IntFeatureData[key] = value;
+               string key, vector<int> value) {
+  appendParams(StringData, key);
+  IntFeatureData[key] = std::move(value);
 }
 
 void setDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
-                  string key, const vector<double>& value) {
-  string params;
-  getStrParam(StringData, "params", params);
-  key += params;
-  DoubleFeatureData[key] = value;
+                  string key, vector<double> value) {
+  appendParams(StringData, key);
+  clearVoltageDerivatives(DoubleFeatureData, key);
+  DoubleFeatureData[key] = std::move(value);
 }
 
 /*
@@ -89,12 +152,12 @@ void setDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
  */
 int getIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
               string strFeature, vector<int>& v) {
-  string params;
-  getStrParam(StringData, "params", params);
-  strFeature += params;
+  appendParams(StringData, strFeature);
   mapStr2intVec::iterator mapstr2IntItr(IntFeatureData.find(strFeature));
   if (mapstr2IntItr == IntFeatureData.end()) {
-    GErrorStr += "\nFeature [" + strFeature + "] is missing\n";
+    if (reportError(EFEL_ERROR_MISSING_FEATURE)) {
+      GErrorStr += "\nFeature [" + strFeature + "] is missing\n";
+    }
     return -1;
   }
   v = mapstr2IntItr->second;
@@ -104,13 +167,13 @@ int getIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
 
 int getDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
                  string strFeature, vector<double>& v) {
-  string params;
-  getStrParam(StringData, "params", params);
-  strFeature += params;
+  appendParams(StringData, strFeature);
   mapStr2doubleVec::iterator mapstr2DoubleItr(
       DoubleFeatureData.find(strFeature));
   if (mapstr2DoubleItr == DoubleFeatureData.end()) {
-    GErrorStr += "\nFeature [" + strFeature + "] is missing\n";
+    if (reportError(EFEL_ERROR_MISSING_FEATURE)) {
+      GErrorStr += "\nFeature [" + strFeature + "] is missing\n";
+    }
     return -1;
   }
   v = mapstr2DoubleItr->second;
@@ -118,14 +181,44 @@ int getDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
   return (v.size());
 }
 
+int getIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
+              string strFeature, ConstVecRef<int>& v) {
+  appendParams(StringData, strFeature);
+  mapStr2intVec::const_iterator mapstr2IntItr(IntFeatureData.find(strFeature));
+  if (mapstr2IntItr == IntFeatureData.end()) {
+    if (reportError(EFEL_ERROR_MISSING_FEATURE)) {
+      GErrorStr += "\nFeature [" + strFeature + "] is missing\n";
+    }
+    return -1;
+  }
+  v.bind(mapstr2IntItr->second);
+
+  return (v.size());
+}
+
+int getDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
+                 string strFeature, ConstVecRef<double>& v) {
+  appendParams(StringData, strFeature);
+  mapStr2doubleVec::const_iterator mapstr2DoubleItr(
+      DoubleFeatureData.find(strFeature));
+  if (mapstr2DoubleItr == DoubleFeatureData.end()) {
+    if (reportError(EFEL_ERROR_MISSING_FEATURE)) {
+      GErrorStr += "\nFeature [" + strFeature + "] is missing\n";
+    }
+    return -1;
+  }
+  v.bind(mapstr2DoubleItr->second);
+
+  return (v.size());
+}
+
 int CheckInIntmap(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
                   string strFeature, int& nSize) {
-  string params;
-  getStrParam(StringData, "params", params);
-  strFeature += params;
+  appendParams(StringData, strFeature);
   mapStr2intVec::const_iterator mapstr2IntItr(IntFeatureData.find(strFeature));
   if (mapstr2IntItr != IntFeatureData.end()) {
     nSize = mapstr2IntItr->second.size();
+    GCacheHits++;
     return 1;
   }
   nSize = -1;
@@ -134,19 +227,76 @@ int CheckInIntmap(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
 
 int CheckInDoublemap(mapStr2doubleVec& DoubleFeatureData,
                      mapStr2Str& StringData, string strFeature, int& nSize) {
-  string params;
-  getStrParam(StringData, "params", params);
-  strFeature += params;
+  appendParams(StringData, strFeature);
   mapStr2doubleVec::const_iterator mapstr2DoubleItr(
       DoubleFeatureData.find(strFeature));
   if (mapstr2DoubleItr != DoubleFeatureData.end()) {
     nSize = mapstr2DoubleItr->second.size();
+    GCacheHits++;
     return 1;
   }
   nSize = -1;
   return 0;
 }
 
+// Keys of the cached derivatives, followed by the trace parameters
+static const char* const voltageDerivativeKeys[] = {"__dV/dt_central",
+                                                    "__d2V/dt2_central"};
+
+void clearVoltageDerivatives(mapStr2doubleVec& DoubleFeatureData,
+                             const string& key) {
+  if (key.empty() || (key[0] != 'V' && key[0] != 'T') ||
+      (key.size() > 1 && key[1] != ';')) {
+    return;
+  }
+  const string params(key, 1);
+  for (size_t i = 0; i < 2; i++) {
+    DoubleFeatureData.erase(voltageDerivativeKeys[i] + params);
+  }
+}
+
+int getVoltageDerivative(mapStr2doubleVec& DoubleFeatureData,
+                         mapStr2Str& StringData, int order,
+                         ConstVecRef<double>& derivative) {
+  if (order != 1 && order != 2) {
+    if (reportError(EFEL_ERROR_FEATURE_FAILED)) {
+      GErrorStr +=
+          "\nOnly first and second voltage derivatives are supported\n";
+    }
+    return -1;
+  }
+  const string key(voltageDerivativeKeys[order - 1]);
+  string cacheKey(key);
+  appendParams(StringData, cacheKey);
+  mapStr2doubleVec::const_iterator cached(DoubleFeatureData.find(cacheKey));
+  if (cached != DoubleFeatureData.end()) {
+    derivative.bind(cached->second);
+    return derivative.size();
+  }
+
+  ConstVecRef<double> v, t;
+  if (order == 1) {
+    if (getDoubleVec(DoubleFeatureData, StringData, "V", v) < 0) return -1;
+  } else {
+    if (getVoltageDerivative(DoubleFeatureData, StringData, 1, v) < 0) {
+      return -1;
+    }
+  }
+  if (getDoubleVec(DoubleFeatureData, StringData, "T", t) < 0) return -1;
+  if (v.size() < 2 || t.size() < 2) {
+    if (reportError(EFEL_ERROR_INVALID_TRACE)) {
+      GErrorStr += "\nV and T need at least 2 points to be derived\n";
+    }
+    return -1;
+  }
+
+  vector<double> dvdt;
+  getCentralDifferenceDvdt(v, t, dvdt);
+  setDoubleVec(DoubleFeatureData, StringData, key, std::move(dvdt));
+  derivative.bind(DoubleFeatureData.find(cacheKey)->second);
+  return derivative.size();
+}
+
 /*
  *  Take a wildcard string as an argument:
  *  wildcards seperated by ';' e.g. "APWaveForm;soma"
@@ -154,15 +304,17 @@ int CheckInDoublemap(mapStr2doubleVec& DoubleFeatureData,
  *  e.g. "V;APWaveForm200;soma", "V;APWaveForm240;soma"
  *  Finally return a vector of all parameter strings
  *  e.g. (";APWaveForm200;soma", ";APWaveForm240;soma", ...)
+ *  The traces are returned sorted by name, independent of the order of the
+ *  hash map.
  */
 void getTraces(mapStr2doubleVec& mapDoubleData, const string& wildcards,
                vector<string>& params) {
   mapStr2doubleVec::const_iterator map_it;
-  string featurename;
+  vector<string> tracenames;
   params.clear();
   for (map_it = mapDoubleData.begin(); map_it != mapDoubleData.end();
        ++map_it) {
-    featurename = map_it->first;
+    const string& featurename = map_it->first;
     // find traces
     if (featurename.find("V;") != string::npos) {
       bool match = true;
@@ -182,10 +334,14 @@ void getTraces(mapStr2doubleVec& mapDoubleData, const string& wildcards,
         oldpos = nextpos;
       } while (nextpos != (int)wildcards.size());
       if (match) {
-        params.push_back(featurename.substr(1));
+        tracenames.push_back(featurename);
       }
     }
   }
+  std::sort(tracenames.begin(), tracenames.end());
+  for (size_t i = 0; i < tracenames.size(); i++) {
+    params.push_back(tracenames[i].substr(1));
+  }
 }
 
 // mean over all traces obtained with the same stimulus
@@ -200,9 +356,12 @@ int mean_traces_double(mapStr2doubleVec& DoubleFeatureData,
       vector<double> elem_feature;
       getDoubleParam(DoubleFeatureData, feature + stim_params[i], elem_feature);
       if (i_elem > (int)elem_feature.size() - 1 || elem_feature.size() == 0) {
-        GErrorStr +=
-            "mean_traces_double: feature vector of the elementary feature does "
-            "not contain that many elements.\n";
+        if (reportError(EFEL_ERROR_MISSING_FEATURE)) {
+          GErrorStr +=
+              "mean_traces_double: feature vector of the elementary feature "
+              "does not contain that many elements.\n";
+        }
+        return -1;
       }
       if (i_elem == -1) {
         sum += elem_feature.back();
@@ -231,9 +390,12 @@ int std_traces_double(mapStr2doubleVec& DoubleFeatureData,
       getDoubleParam(DoubleFeatureData, feature + stim_params[i], elem_feature);
       if (i_elem > (int)elem_feature.size() - 1 ||
           (int)elem_feature.size() == 0) {
-        GErrorStr +=
-            "std_traces_double: feature vector of the elementary feature does "
-            "not contain that many elements.\n";
+        if (reportError(EFEL_ERROR_MISSING_FEATURE)) {
+          GErrorStr +=
+              "std_traces_double: feature vector of the elementary feature "
+              "does not contain that many elements.\n";
+        }
+        return -1;
       }
       if (i_elem == -1) {
         v = elem_feature.back();
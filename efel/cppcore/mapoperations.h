@@ -23,33 +23,119 @@
 #include "types.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 using std::string;
 using std::vector;
 
-extern string GErrorStr;
+extern thread_local string GErrorStr;
+
+// Kind of an error, the structured counterpart of the GErrorStr messages
+enum eFELErrorCode {
+  EFEL_ERROR_NONE = 0,
+  // the feature function failed, e.g. on a trace without enough spikes
+  EFEL_ERROR_FEATURE_FAILED = 1,
+  // a setting or the trace parameters are missing
+  EFEL_ERROR_MISSING_PARAMETER = 2,
+  // a feature that is needed could not be calculated
+  EFEL_ERROR_MISSING_FEATURE = 3,
+  // the feature is not in the dependency file
+  EFEL_ERROR_UNKNOWN_FEATURE = 4,
+  // T and V are not a valid trace
+  EFEL_ERROR_INVALID_TRACE = 5
+};
+// Code of the first error since it was reset to EFEL_ERROR_NONE, per thread
+extern thread_local int GErrorCode;
+// When false, the errors of the map operations (e.g. the misses of optional
+// settings) only set GErrorCode and don't build a message for GErrorStr. On
+// by default, the batches turn it off in their threads.
+extern thread_local bool GErrorMessages;
+// Set GErrorCode if no error happened yet, returns GErrorMessages: the
+// caller appends its message to GErrorStr only if it returns true
+bool reportError(int code);
+// Short description of an eFELErrorCode
+const char* errorCodeDescription(int code);
+// Number of CheckIn*map calls that found the feature already calculated, per
+// thread like GErrorStr. Read by the profiler of cFeature.
+extern thread_local size_t GCacheHits;
+
+/*
+ * Read-only reference to a vector in one of the feature maps. It is filled
+ * by the get(Int|Double)Vec / getDoubleParam overloads below, which unlike
+ * their vector counterparts don't copy the data. It converts implicitly to
+ * const vector<T>&, so it can be passed to functions that take one.
+ * The reference stays valid as long as the map entry is not removed.
+ */
+template <typename T>
+class ConstVecRef {
+  const vector<T>* vec;
+
+  static const vector<T>& emptyVector() {
+    static const vector<T> empty_vec;
+    return empty_vec;
+  }
+
+ public:
+  typedef typename vector<T>::const_iterator const_iterator;
+  typedef typename vector<T>::size_type size_type;
+
+  ConstVecRef() : vec(&emptyVector()) {}
+  void bind(const vector<T>& v) { vec = &v; }
+
+  const_iterator begin() const { return vec->begin(); }
+  const_iterator end() const { return vec->end(); }
+  size_type size() const { return vec->size(); }
+  bool empty() const { return vec->empty(); }
+  const T& operator[](size_type i) const { return (*vec)[i]; }
+  const T& front() const { return vec->front(); }
+  const T& back() const { return vec->back(); }
+  const vector<T>& get() const { return *vec; }
+  operator const vector<T>&() const { return *vec; }
+};
 
 int getIntParam(mapStr2intVec& IntFeatureData, const string& param,
                 vector<int>& vec);
 int getDoubleParam(mapStr2doubleVec& DoubleFeatureData, const string& param,
                    vector<double>& vec);
+int getDoubleParam(mapStr2doubleVec& DoubleFeatureData, const string& param,
+                   ConstVecRef<double>& vec);
 int getStrParam(mapStr2Str& StringData, const string& param, string& value);
 
+// The value is taken by value and moved into the map, pass std::move(result)
+// to store a result without copying it
 void setIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
-               string key, const vector<int>& value);
+               string key, vector<int> value);
 void setDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
-                  string key, const vector<double>& value);
+                  string key, vector<double> value);
 
 int getDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
                  string strFeature, vector<double>& v);
 int getIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
               string strFeature, vector<int>& v);
+int getDoubleVec(mapStr2doubleVec& DoubleFeatureData, mapStr2Str& StringData,
+                 string strFeature, ConstVecRef<double>& v);
+int getIntVec(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
+              string strFeature, ConstVecRef<int>& v);
 int CheckInDoublemap(mapStr2doubleVec& DoubleFeatureData,
                      mapStr2Str& StringData, string strFeature, int& nSize);
 int CheckInIntmap(mapStr2intVec& IntFeatureData, mapStr2Str& StringData,
                   string strFeature, int& nSize);
 
+/*
+ * Derivative of "V" with respect to "T" (the "params" entry applied), by
+ * central differences (getCentralDifferenceDvdt). order 1 gives dV/dt,
+ * order 2 d2V/dt2. It is computed on first use and kept in the double map,
+ * so all the features of a trace share it.
+ */
+int getVoltageDerivative(mapStr2doubleVec& DoubleFeatureData,
+                         mapStr2Str& StringData, int order,
+                         ConstVecRef<double>& derivative);
+// Drops the derivatives cached for a trace when its "V" or "T" (with any
+// trace parameters, e.g. "V;location_soma") is set to new values
+void clearVoltageDerivatives(mapStr2doubleVec& DoubleFeatureData,
+                             const string& key);
+
 // eCode feature convenience function
 int mean_traces_double(mapStr2doubleVec& DoubleFeatureData,
                        const string& feature, const string& stimulus_name,
@@ -21,13 +21,17 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-
-typedef std::map<std::string, std::vector<int> > mapStr2intVec;
-typedef std::map<std::string, std::vector<double> > mapStr2doubleVec;
-typedef std::map<std::string, std::string> mapStr2Str;
+/* Feature data stores. These are looked up by name for every dependency of
+ * every feature, hence hash tables instead of ordered maps. Code that needs a
+ * deterministic order has to sort the keys itself.
+ */
+typedef std::unordered_map<std::string, std::vector<int> > mapStr2intVec;
+typedef std::unordered_map<std::string, std::vector<double> > mapStr2doubleVec;
+typedef std::unordered_map<std::string, std::string> mapStr2Str;
 
 typedef int (*feature_function)(mapStr2intVec &,
                                 mapStr2doubleVec &,
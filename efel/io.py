@@ -252,3 +252,57 @@ def load_neo_file(file_name, stim_start=None, stim_end=None, **kwargs):
         efel_blocks.append(efel_segments)
 
     return efel_blocks
+
+
+def write_trace_file(file_name, time=None, voltage=None, dtype='float64',
+                     layout='t_then_v', t0=0.0, dt=None):
+    """Write a trace to a binary trace file
+
+    The file can be passed to cppcore.setTraceFile (setTraceFile in the C
+    API), which maps it instead of copying the samples.
+
+    Args:
+        file_name: Path of the file to write
+        time: Times of the samples, not used with layout 'v_only'
+        voltage: Voltages of the samples
+        dtype: 'float64' or 'float32'
+        layout: 't_then_v' (all times, then all voltages), 'interleaved'
+            (time, voltage pairs) or 'v_only' (voltages sampled every dt
+            starting at t0)
+        t0: Time of the first sample for layout 'v_only'
+        dt: Sampling step for layout 'v_only'
+    """
+    import numpy
+    import struct
+
+    layouts = {'t_then_v': 0, 'interleaved': 1, 'v_only': 2}
+    if layout not in layouts:
+        raise ValueError('write_trace_file: unknown layout %s' % layout)
+    dtype = numpy.dtype(dtype)
+    if dtype not in (numpy.dtype('float64'), numpy.dtype('float32')):
+        raise ValueError('write_trace_file: dtype has to be float64 or '
+                         'float32')
+
+    voltage = numpy.asarray(voltage, dtype=dtype).ravel()
+    if layout == 'v_only':
+        if dt is None or dt <= 0:
+            raise ValueError('write_trace_file: layout v_only needs a '
+                             'positive dt')
+        samples = voltage
+    else:
+        time = numpy.asarray(time, dtype=dtype).ravel()
+        if len(time) != len(voltage):
+            raise ValueError('write_trace_file: time and voltage need the '
+                             'same length')
+        if layout == 't_then_v':
+            samples = numpy.concatenate((time, voltage))
+        else:
+            samples = numpy.column_stack((time, voltage)).ravel()
+        dt = 0.0
+
+    # see TraceFile.h
+    header = struct.pack('=8sIIIIQdd', b'EFELTRC\0', 1, dtype.itemsize,
+                         layouts[layout], 0, len(voltage), t0, dt)
+    with open(file_name, 'wb') as trace_file:
+        trace_file.write(header)
+        trace_file.write(samples.astype(dtype.newbyteorder('=')).tobytes())
@@ -171,13 +171,13 @@ def initburst_sahp():
 
 def _get_cpp_feature(feature_name):
     """Get cpp feature"""
-    cppcoreFeatureValues = list()
-    exitCode = efel.cppcore.getFeature(feature_name, cppcoreFeatureValues)
+    exitCode, dtype, feature_buffer = efel.cppcore.getFeatureArray(
+        feature_name)
 
     if exitCode < 0:
         return None
     else:
-        return numpy.array(cppcoreFeatureValues)
+        return numpy.frombuffer(feature_buffer, dtype=dtype)
 
 
 def _get_cpp_data(data_name):
@@ -333,6 +333,188 @@ def test_multiprocessing_traces():
         multiprocessing.pool.MapResult))
 
 
+def test_batch_traces():
+    """basic: Test getFeatureValuesBatch against getFeatureValues"""
+    import efel
+    efel.reset()
+
+    stim_start = 31.2
+    stim_end = 431.2
+
+    time1 = efel.io.load_fragment('%s#col=1' % zeroISIlog1_url)
+    voltage1 = efel.io.load_fragment('%s#col=2' % zeroISIlog1_url)
+
+    trace1 = {}
+
+    trace1['T'] = time1
+    trace1['V'] = voltage1
+    trace1['stim_start'] = [stim_start]
+    trace1['stim_end'] = [stim_end]
+
+    test_data_path = os.path.join(
+        testdata_dir,
+        'basic',
+        'AP_begin_indices_95810005.abf.csv')
+    data2 = numpy.loadtxt(test_data_path)
+
+    voltage2 = data2
+    time2 = numpy.arange(len(voltage2)) * 0.1
+
+    trace2 = {}
+
+    trace2['T'] = time2
+    trace2['V'] = voltage2
+    trace2['stim_start'] = [stim_start]
+    trace2['stim_end'] = [stim_end]
+
+    traces = [trace1, trace2, trace1, trace2, trace1]
+    feature_names = ['peak_time', 'Spikecount', 'AP_amplitude',
+                     'voltage_base', 'AP_begin_indices', 'time_constant']
+
+    feature_values_serial = efel.getFeatureValues(
+        traces, feature_names, raise_warnings=False)
+
+    for n_threads in [1, 3]:
+        feature_values_batch = efel.getFeatureValuesBatch(
+            traces, feature_names, n_threads=n_threads, raise_warnings=False)
+
+        nt.assert_equal(len(feature_values_serial), len(feature_values_batch))
+        for serial, batch in zip(feature_values_serial, feature_values_batch):
+            for feature_name in feature_names:
+                if serial[feature_name] is None:
+                    nt.assert_true(batch[feature_name] is None)
+                else:
+                    numpy.testing.assert_allclose(
+                        serial[feature_name], batch[feature_name], rtol=1e-6)
+
+    nt.assert_raises(
+        ValueError, efel.getFeatureValuesBatch, traces, feature_names,
+        n_threads=-1)
+
+
+def test_batch_errors():
+    """basic: Test the errors returned by getFeatureValuesBatch"""
+    import efel
+    efel.reset()
+
+    flat_trace = {}
+    flat_trace['T'] = numpy.arange(0, 1000, 0.1)
+    flat_trace['V'] = numpy.full(len(flat_trace['T']), -70.0)
+    flat_trace['stim_start'] = [100]
+    flat_trace['stim_end'] = [900]
+    spiking_trace = efel.generateSyntheticTrace(spike_rate=20)
+    del spiking_trace['spike_times']
+
+    traces = [flat_trace, spiking_trace, flat_trace]
+    feature_names = ['peak_time', 'ISI_values', 'time_to_first_spike',
+                     'mean_frequency']
+    feature_values, errors = efel.getFeatureValuesBatch(
+        traces, feature_names, n_threads=2, raise_warnings=False,
+        return_errors=True)
+
+    failed = [(trace_index, feature_name)
+              for trace_index, values in enumerate(feature_values)
+              for feature_name in feature_names if values[feature_name] is None]
+    nt.assert_equal(
+        [(0, 'ISI_values'), (0, 'time_to_first_spike'),
+         (0, 'mean_frequency'), (2, 'ISI_values'),
+         (2, 'time_to_first_spike'), (2, 'mean_frequency')], failed)
+    nt.assert_equal(failed, [error[:2] for error in errors])
+    nt.assert_equal([1] * len(errors), [error[2] for error in errors])
+    nt.ok_('Three spikes required' in errors[0][3])
+    # the messages are shared, not repeated for every failure
+    nt.ok_(errors[0][3] is errors[3][3])
+
+    # errors don't leak into the next trace or into the next batch
+    nt.assert_equal(
+        [], efel.getFeatureValuesBatch(
+            [spiking_trace], feature_names, raise_warnings=False,
+            return_errors=True)[1])
+
+
+def test_batch_traces_pyfeature():
+    """basic: Test getFeatureValuesBatch with a python feature"""
+    import efel
+    efel.reset()
+
+    trace = {}
+    trace['T'] = numpy.arange(0, 100, 0.1)
+    trace['V'] = numpy.ones(len(trace['T'])) * -80.0
+    trace['stim_start'] = [25]
+    trace['stim_end'] = [75]
+
+    nt.assert_raises(
+        Exception, efel.getFeatureValuesBatch, [trace], ['ISIs'])
+
+
+def test_generateSyntheticTrace():
+    """basic: Test the spikes of synthetic traces"""
+
+    import efel
+    efel.reset()
+
+    trace = efel.generateSyntheticTrace(spike_rate=50, noise=0.5, seed=3)
+    nt.assert_equal(40001, len(trace['T']))
+    nt.assert_equal(39, len(trace['spike_times']))
+    feature_values = efel.getFeatureValues([trace], ['peak_time'])[0]
+    numpy.testing.assert_allclose(feature_values['peak_time'],
+                                  trace['spike_times'], atol=0.05)
+
+    # deterministic, also when generated in chunks
+    first = efel.generateSyntheticTrace(
+        noise=0.5, seed=3, first_sample=1000, sample_count=500)
+    numpy.testing.assert_array_equal(first['T'], trace['T'][1000:1500])
+    numpy.testing.assert_array_equal(
+        first['V'],
+        efel.generateSyntheticTrace(noise=0.5, seed=3)['V'][1000:1500])
+
+    nt.assert_raises(ValueError, efel.generateSyntheticTrace, dt=0)
+
+
+def test_feature_stream():
+    """basic: Test FeatureStream against getFeatureValues"""
+    import efel
+    efel.reset()
+
+    stim_start = 31.2
+    stim_end = 431.2
+
+    time = efel.io.load_fragment('%s#col=1' % zeroISIlog1_url)
+    voltage = efel.io.load_fragment('%s#col=2' % zeroISIlog1_url)
+
+    trace = {}
+
+    trace['T'] = time
+    trace['V'] = voltage
+    trace['stim_start'] = [stim_start]
+    trace['stim_end'] = [stim_end]
+
+    feature_names = ['peak_indices', 'peak_time', 'peak_voltage',
+                     'all_ISI_values', 'min_AHP_indices', 'min_AHP_values',
+                     'voltage_base']
+    feature_values = efel.getFeatureValues(
+        [trace], feature_names + ['Spikecount'], raise_warnings=False)[0]
+
+    stream = efel.FeatureStream(stim_start=stim_start)
+    stream_values = dict((feature_name, []) for feature_name in feature_names)
+    for start in range(0, len(time), 777):
+        chunk_values = stream.push(
+            time[start:start + 777], voltage[start:start + 777])
+        for feature_name in feature_names:
+            stream_values[feature_name].extend(chunk_values[feature_name])
+    chunk_values = stream.finish()
+    for feature_name in feature_names:
+        stream_values[feature_name].extend(chunk_values[feature_name])
+
+    for feature_name in feature_names:
+        nt.assert_equal(
+            list(feature_values[feature_name]), stream_values[feature_name])
+    nt.assert_equal(
+        list(feature_values['Spikecount']), list(chunk_values['Spikecount']))
+
+    nt.assert_raises(ValueError, stream.push, [0.0], [-80.0])
+
+
 def test_consecutive_traces():
     """basic: Test if features from two different traces give other results"""
 
@@ -385,6 +567,31 @@ def test_consecutive_traces():
         len(feature_values2[0][feature_name]))
 
 
+def test_settings_after_cppcore_initialize():
+    """basic: Test that the settings are set again after cppcore.Initialize"""
+
+    import efel
+    efel.reset()
+
+    time = efel.io.load_fragment('%s#col=1' % meanfrequency1_url)
+    voltage = efel.io.load_fragment('%s#col=2' % meanfrequency1_url)
+    trace = {}
+    trace['T'] = time
+    trace['V'] = voltage
+    trace['stim_start'] = [500.0]
+    trace['stim_end'] = [900.0]
+
+    feature_values = efel.getFeatureValues([trace], ['Spikecount'])
+    nt.assert_equal(5, feature_values[0]['Spikecount'][0])
+
+    # someone else initialises cppcore with other settings in between
+    efel.cppcore.Initialize(efel.getDependencyFileLocation(), "log")
+    efel.cppcore.setSettingDouble('Threshold', [100.0])
+
+    feature_values = efel.getFeatureValues([trace], ['Spikecount'])
+    nt.assert_equal(5, feature_values[0]['Spikecount'][0])
+
+
 def test_stimstart_stimend():
     """basic: Test exception when stimstart or stimend are wrong"""
 
@@ -778,6 +985,72 @@ def test_AP_begin_indices1():
         len(feature_values[0]['AP_duration_half_width']))
 
 
+def test_interpolate_on_grid_values():
+    """basic: Test the values of a trace sampled at interp_step"""
+
+    import efel
+    efel.reset()
+
+    data = numpy.loadtxt(
+        os.path.join(testdata_dir, 'basic', 'initburst_sahp_error.txt'))
+
+    trace = {}
+
+    trace['T'] = data[:, 0]
+    trace['V'] = data[:, 1]
+    trace['stim_start'] = [700.0]
+    trace['stim_end'] = [2700.0]
+
+    # The trace is sampled at the default interp_step of 0.1 ms, so it is
+    # not resampled and the peaks are the recorded samples. Resampling used
+    # to change them in the last bits.
+    feature_values = efel.getFeatureValues(
+        [trace], ['peak_indices', 'peak_voltage', 'AP_height'])[0]
+    peak_indices = feature_values['peak_indices']
+    numpy.testing.assert_array_equal(
+        data[peak_indices, 1], feature_values['peak_voltage'])
+    numpy.testing.assert_array_equal(
+        data[peak_indices, 1], feature_values['AP_height'])
+    nt.assert_equal(12.28848506, round(feature_values['peak_voltage'][0], 8))
+
+
+def test_AP_begin_indices_interpolated():
+    """basic: Test AP_begin_indices on a trace interpolated at a small step"""
+
+    import efel
+
+    time = efel.io.load_fragment('%s#col=1' % ahptest1_url)
+    voltage = efel.io.load_fragment('%s#col=2' % ahptest1_url)
+
+    trace = {}
+
+    trace['T'] = time
+    trace['V'] = voltage
+    trace['stim_start'] = [700.0]
+    trace['stim_end'] = [2700.0]
+
+    # at these steps the interpolated V is one sample shorter than T
+    expected_begin_indices = {
+        0.025: [28876, 30878, 36284, 41855, 47271, 52569, 57777, 62918, 68005,
+                73052, 78067, 83057, 88028, 92983, 97926, 102859, 107784],
+        0.01: [72188, 77194, 90710, 104637, 118177, 131422, 144443, 157293,
+               170012, 182629, 195167, 207642, 220069, 232457, 244814, 257147,
+               269461]}
+    for interp_step, begin_indices in expected_begin_indices.items():
+        efel.reset()
+        efel.setDoubleSetting('interp_step', interp_step)
+        feature_values = efel.getFeatureValues(
+            [trace], ['AP_begin_indices', 'AP_amplitude', 'AP_rise_time'],
+            raise_warnings=False)[0]
+
+        numpy.testing.assert_array_equal(
+            begin_indices, feature_values['AP_begin_indices'])
+        nt.assert_equal(len(begin_indices),
+                        len(feature_values['AP_amplitude']))
+        nt.assert_equal(len(begin_indices),
+                        len(feature_values['AP_rise_time']))
+
+
 def test_mean_frequency1():
     """basic: Test mean_frequency 1"""
 
@@ -1075,6 +1348,41 @@ def test_APlast_width():
     spike_half_width = feature_values[0]['spike_half_width']
     nt.assert_equal(APlast_width, spike_half_width[-1])
 
+    # without spikes there is no spike_half_width
+    trace['V'] = numpy.full(len(time), -65.0)
+    feature_values = efel.getFeatureValues([trace], ['APlast_width'],
+                                           raise_warnings=False)
+    nt.assert_equal(None, feature_values[0]['APlast_width'])
+
+
+def test_stimulus_features_without_spikes():
+    """basic: Test the features over stimuli on traces without spikes"""
+
+    import efel
+    efel.reset()
+
+    time = efel.io.load_fragment('%s#col=1' % meanfrequency1_url)
+    voltage = numpy.full(len(time), -65.0)
+
+    trace = {}
+    trace['T'] = time
+    trace['V'] = voltage
+    trace['stim_start'] = [500.0]
+    trace['stim_end'] = [900.0]
+    for params in [';APWaveForm200', ';IDthreshold100', ';IDthreshold120']:
+        trace['T' + params] = time
+        trace['V' + params] = voltage
+        trace['stim_start' + params] = [500.0]
+        trace['stim_end' + params] = [900.0]
+    trace['stimulus_current;IDthreshold100'] = [0.1]
+    trace['stimulus_current;IDthreshold120'] = [0.12]
+
+    features = ['E6', 'E39']
+    feature_values = efel.getFeatureValues([trace], features,
+                                           raise_warnings=False)
+    for feature in features:
+        nt.assert_equal(None, feature_values[0][feature])
+
 
 def test_derivwindow1():
     """basic: Test DerivativeWindow"""
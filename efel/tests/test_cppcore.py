@@ -155,6 +155,61 @@ class TestCppcore(object):
         nt.eq_(5, len(feature_values))
         nt.eq_([5665, 6066, 6537, 7170, 8275], feature_values)
 
+    def test_setFeatureDouble_buffer(self):  # pylint: disable=R0201
+        """cppcore: Testing setFeatureDouble with numpy arrays"""
+        import efel.cppcore
+        data = np.array([[0.0, -80.0], [0.1, -79.5], [0.2, -79.0]])
+
+        # contiguous float64 array
+        efel.cppcore.setFeatureDouble('T', np.ascontiguousarray(data[:, 0]))
+        # strided float64 array
+        efel.cppcore.setFeatureDouble('V', data[:, 1])
+        # float32 array, read through the sequence protocol
+        efel.cppcore.setFeatureDouble(
+            'stim_start', np.array([0.1], dtype=np.float32))
+
+        nt.assert_equal(
+            list(data[:, 0]), efel.cppcore.getMapDoubleData('T'))
+        nt.assert_equal(
+            list(data[:, 1]), efel.cppcore.getMapDoubleData('V'))
+        nt.assert_almost_equal(
+            0.1, efel.cppcore.getMapDoubleData('stim_start')[0])
+
+    @nt.raises(TypeError)
+    def test_setFeatureDouble_wrong_type(self):  # pylint: disable=R0201
+        """cppcore: Testing setFeatureDouble with a non-sequence"""
+        import efel.cppcore
+        efel.cppcore.setFeatureDouble('T', 1.0)
+
+    def test_getFeatureArray(self):
+        """cppcore: Testing getFeatureArray"""
+        import efel.cppcore
+        self.setup_data()
+
+        # get double feature
+        exit_code, dtype, feature_buffer = efel.cppcore.getFeatureArray(
+            'AP_amplitude')
+        feature_values = np.frombuffer(feature_buffer, dtype=dtype)
+        nt.eq_(5, exit_code)
+        nt.eq_(np.float64, feature_values.dtype)
+        nt.ok_(
+            np.allclose(
+                [80.45724099440199, 80.46320199354948, 80.73300299176428,
+                 80.9965359926715, 81.87292599493423], feature_values))
+
+        # get int feature
+        exit_code, dtype, feature_buffer = efel.cppcore.getFeatureArray(
+            'AP_fall_indices')
+        feature_values = np.frombuffer(feature_buffer, dtype=dtype)
+        nt.eq_(np.int32, feature_values.dtype)
+        nt.eq_([5665, 6066, 6537, 7170, 8275], list(feature_values))
+
+    @nt.raises(TypeError)
+    def test_getFeatureArray_non_existant(self):  # pylint: disable=R0201
+        """cppcore: Testing getFeatureArray with unknown feature"""
+        import efel.cppcore
+        efel.cppcore.getFeatureArray("does_not_exist")
+
     def test_getFeature_failure(self):  # pylint: disable=R0201
         """cppcore: Testing failure exit code in getFeature"""
         import efel.cppcore
@@ -162,6 +217,345 @@ class TestCppcore(object):
         return_value = efel.cppcore.getFeature("AP_amplitude", feature_values)
         nt.assert_equal(return_value, -1)
 
+    def test_getFeature_shared_dependency_failure(self):
+        """cppcore: Testing failures of shared dependencies"""
+        import efel.cppcore
+        efel.cppcore.getgError()
+
+        # Both features depend on peak_indices, which fails without data
+        nt.assert_equal(
+            efel.cppcore.getFeature("AP_amplitude", list()), -1)
+        error = efel.cppcore.getgError()
+        nt.assert_equal(
+            efel.cppcore.getFeature("AP_amplitude", list()), -1)
+        nt.assert_equal(error, efel.cppcore.getgError())
+        nt.assert_equal(
+            efel.cppcore.getFeature("peak_voltage", list()), -1)
+        nt.ok_(efel.cppcore.getgError())
+
+        # Setting the data lets the failed steps run again
+        self.setup_data()
+        feature_values = list()
+        nt.assert_equal(
+            efel.cppcore.getFeature("AP_amplitude", feature_values), 5)
+        nt.assert_equal(
+            efel.cppcore.getFeature("peak_voltage", feature_values), 5)
+
+    def test_dependency_cycle(self):  # pylint: disable=R0201
+        """cppcore: Testing a dependency file with a cycle"""
+        import efel.cppcore
+        efel.cppcore.getgError()
+        tempdir = tempfile.mkdtemp('efel_tests')
+        try:
+            deptree_path = os.path.join(tempdir, 'deptree.txt')
+            with open(deptree_path, 'w') as deptree_file:
+                deptree_file.write(
+                    'LibV1:interpolate\n'
+                    'LibV5:peak_indices #LibV1:interpolate #LibV5:peak_time\n'
+                    'LibV5:peak_time #LibV5:peak_indices\n')
+            efel.cppcore.Initialize(deptree_path, tempdir)
+            nt.ok_(
+                'Cyclic dependency in the dependency file: '
+                'LibV5:peak_indices -> LibV5:peak_time -> LibV5:peak_indices'
+                in efel.cppcore.getgError())
+        finally:
+            shutil.rmtree(tempdir)
+
+    def test_dependency_file_changes(self):  # pylint: disable=R0201
+        """cppcore: Testing reloading of a modified dependency file"""
+        import efel.cppcore
+        tempdir = tempfile.mkdtemp('efel_tests')
+        try:
+            deptree_path = os.path.join(tempdir, 'deptree.txt')
+            deptree = ('LibV1:interpolate\n'
+                       'LibV5:peak_indices #LibV1:interpolate\n')
+            with open(deptree_path, 'w') as deptree_file:
+                deptree_file.write(deptree)
+            nt.assert_raises(
+                ValueError, efel.cppcore.getFeatureValuesBatch,
+                deptree_path, [], ['peak_voltage'], {}, {})
+
+            with open(deptree_path, 'w') as deptree_file:
+                deptree_file.write(
+                    deptree + 'LibV1:peak_voltage #LibV5:peak_indices\n')
+            nt.assert_equal(
+                ([], [],
+                 ['No error',
+                  'The feature could not be calculated',
+                  'A parameter is missing',
+                  'A feature that is needed could not be calculated',
+                  'The feature is not in the dependency file',
+                  'T and V are not a valid trace']),
+                efel.cppcore.getFeatureValuesBatch(
+                    deptree_path, [], ['peak_voltage'], {}, {}))
+        finally:
+            shutil.rmtree(tempdir)
+
+    def test_dependency_file_changes_within_a_second(self):
+        """cppcore: Testing reloading of a dependency file rewritten quickly"""
+        import time
+        import efel.cppcore
+        tempdir = tempfile.mkdtemp('efel_tests')
+        try:
+            deptree_path = os.path.join(tempdir, 'deptree.txt')
+            peak_voltage = 'LibV1:peak_voltage #LibV5:peak_indices\n'
+            deptree = ('LibV1:interpolate\n'
+                       'LibV5:peak_indices #LibV1:interpolate\n')
+            mtime_ns = int(time.time()) * 1000000000
+            # Both versions have the same size and modification second
+            for version, contents in enumerate(
+                    [deptree + peak_voltage,
+                     deptree + ' ' * (len(peak_voltage) - 1) + '\n']):
+                with open(deptree_path, 'w') as deptree_file:
+                    deptree_file.write(contents)
+                os.utime(deptree_path,
+                         ns=(mtime_ns + version * 1000,
+                             mtime_ns + version * 1000))
+                if version == 0:
+                    efel.cppcore.getFeatureValuesBatch(
+                        deptree_path, [], ['peak_voltage'], {}, {})
+                else:
+                    nt.assert_raises(
+                        ValueError, efel.cppcore.getFeatureValuesBatch,
+                        deptree_path, [], ['peak_voltage'], {}, {})
+        finally:
+            shutil.rmtree(tempdir)
+
+    def test_dependency_file_cache_limit(self):  # pylint: disable=R0201
+        """cppcore: Testing that the dependency tables of old files are freed"""
+        import efel.cppcore
+        tempdir = tempfile.mkdtemp('efel_tests')
+        try:
+            deptree_paths = []
+            for i in range(9):
+                deptree_path = os.path.join(tempdir, 'deptree%d.txt' % i)
+                with open(deptree_path, 'w') as deptree_file:
+                    deptree_file.write('LibV1:interpolate\n')
+                deptree_paths.append(deptree_path)
+
+            # resetTrace requests the file of the engine again, it is the
+            # most recent one
+            efel.cppcore.Initialize(deptree_paths[0], tempdir)
+            for deptree_path in deptree_paths[1:8]:
+                efel.cppcore.getFeatureValuesBatch(
+                    deptree_path, [], [], {}, {})
+            nt.assert_not_equal(0, efel.cppcore.resetTrace())
+
+            # eight other files drop the tables of the first one
+            for deptree_path in deptree_paths[1:]:
+                efel.cppcore.getFeatureValuesBatch(
+                    deptree_path, [], [], {}, {})
+            nt.assert_equal(0, efel.cppcore.resetTrace())
+        finally:
+            shutil.rmtree(tempdir)
+
+    def test_Initialize_resets_data(self):
+        """cppcore: Testing that Initialize drops the data of a trace"""
+        import efel
+        self.setup_data()
+        nt.assert_equal(5, efel.cppcore.getFeature('peak_indices', list()))
+
+        efel.cppcore.Initialize(efel.getDependencyFileLocation(), "log")
+        nt.assert_equal(-1, efel.cppcore.getFeature('peak_indices', list()))
+
+    def test_resetTrace(self):
+        """cppcore: Testing resetTrace keeps the settings"""
+        import efel
+        generation = efel.cppcore.Initialize(
+            efel.getDependencyFileLocation(), "log")
+        efel.cppcore.setSettingDouble('Threshold', [-30.0])
+        efel.cppcore.setSettingInt('max_spike_skip', [3])
+        self.setup_data()
+        nt.assert_equal(5, efel.cppcore.getFeature('peak_indices', list()))
+
+        nt.assert_equal(generation, efel.cppcore.resetTrace())
+        nt.assert_equal(-1, efel.cppcore.getFeature('peak_indices', list()))
+        nt.assert_equal([-30.0], efel.cppcore.getMapDoubleData('Threshold'))
+        nt.assert_equal([3], efel.cppcore.getMapIntData('max_spike_skip'))
+
+        # A new V starts a new trace as well
+        efel.cppcore.setFeatureDouble('V', [-80.0, -80.0])
+        nt.assert_equal([-30.0], efel.cppcore.getMapDoubleData('Threshold'))
+
+        # Initialize drops the settings
+        new_generation = efel.cppcore.Initialize(
+            efel.getDependencyFileLocation(), "log")
+        nt.assert_not_equal(generation, new_generation)
+        nt.assert_equal(new_generation, efel.cppcore.resetTrace())
+
+    def test_profile(self):
+        """cppcore: Testing the profile of the feature calculations"""
+        import efel
+        efel.cppcore.resetProfile()
+        efel.cppcore.setProfiling(True)
+        try:
+            self.setup_data()
+            efel.cppcore.getFeature('peak_indices', list())
+            efel.cppcore.getFeature('peak_time', list())
+            # a new setting runs the steps again, they find their values
+            efel.cppcore.setFeatureDouble('stim_end', [900.0])
+            efel.cppcore.getFeature('peak_indices', list())
+            profile = efel.cppcore.getProfile()
+        finally:
+            efel.cppcore.setProfiling(False)
+            efel.cppcore.resetProfile()
+
+        nt.assert_equal(
+            set(['LibV1:interpolate', 'LibV5:peak_indices', 'LibV1:peak_time']),
+            set(profile.keys()))
+        peak_indices = profile['LibV5:peak_indices']
+        nt.assert_equal(2, peak_indices['calls'])
+        nt.assert_equal(1, peak_indices['cache_hits'])
+        nt.assert_equal(10, peak_indices['output_size'])
+        nt.ok_(peak_indices['time'] > 0)
+        nt.assert_equal(1, profile['LibV1:peak_time']['calls'])
+        nt.assert_equal(0, profile['LibV1:peak_time']['cache_hits'])
+
+        self.setup_data()
+        efel.cppcore.getFeature('peak_indices', list())
+        nt.assert_equal({}, efel.cppcore.getProfile())
+
+    def test_interpolate_on_grid(self):  # pylint: disable=R0201
+        """cppcore: Testing interpolate keeps traces sampled at interp_step"""
+        import efel
+        time = []
+        t = 0.0
+        for _ in range(1000):
+            time.append(t)
+            t += 0.1
+        voltage = [-80.0 + 10.0 * np.sin(x) for x in time]
+        efel.cppcore.setFeatureDouble('T', time)
+        efel.cppcore.setFeatureDouble('V', voltage)
+        efel.cppcore.setFeatureDouble('interp_step', [0.1])
+        efel.cppcore.setFeatureDouble('stim_start', [0.0])
+        efel.cppcore.setFeatureDouble('stim_end', [50.0])
+        nt.assert_equal(
+            1, efel.cppcore.getFeature('maximum_voltage', list()))
+        nt.assert_equal(time, efel.cppcore.getMapDoubleData('T'))
+        nt.assert_equal(voltage, efel.cppcore.getMapDoubleData('V'))
+
+        # Traces with other time points are still resampled
+        efel.cppcore.Initialize(efel.getDependencyFileLocation(), "log")
+        efel.cppcore.setFeatureDouble('T', [0.0, 0.25, 0.5])
+        efel.cppcore.setFeatureDouble('V', [0.0, 1.0, 2.0])
+        efel.cppcore.setFeatureDouble('interp_step', [0.1])
+        efel.cppcore.setFeatureDouble('stim_start', [0.0])
+        efel.cppcore.setFeatureDouble('stim_end', [0.3])
+        nt.assert_equal(
+            1, efel.cppcore.getFeature('maximum_voltage', list()))
+        nt.assert_equal(6, len(efel.cppcore.getMapDoubleData('T')))
+
+    def test_voltage_derivative_cache(self):
+        """cppcore: Testing the dV/dt shared by the features of a trace"""
+        import efel
+        self.setup_data()
+        efel.cppcore.setFeatureDouble('AP_phaseslope_range', [2.0])
+        nt.assert_equal(5, efel.cppcore.getFeature('AP_begin_indices', list()))
+        nt.assert_equal(5, efel.cppcore.getFeature('AP_phaseslope', list()))
+
+        # computed on the interpolated trace
+        time = np.array(efel.cppcore.getMapDoubleData('T'))
+        voltage = np.array(efel.cppcore.getMapDoubleData('V'))
+        dvdt = efel.cppcore.getMapDoubleData('__dV/dt_central')
+        nt.assert_equal(len(time), len(dvdt))
+        nt.ok_(np.allclose(np.gradient(voltage) / np.gradient(time), dvdt))
+
+    def test_time_window_boundaries(self):  # pylint: disable=R0201
+        """cppcore: Testing time windows starting on and between samples"""
+        import efel
+        time = [i * 0.125 for i in range(800)]
+        voltage = [float(i) for i in range(800)]
+        for stim_start, expected in [(10.0, 76.0), (10.1, 76.5)]:
+            efel.cppcore.Initialize(efel.getDependencyFileLocation(), "log")
+            efel.cppcore.setFeatureDouble('T', time)
+            efel.cppcore.setFeatureDouble('V', voltage)
+            efel.cppcore.setFeatureDouble('interp_step', [0.125])
+            efel.cppcore.setFeatureDouble('stim_start', [stim_start])
+            efel.cppcore.setFeatureDouble('stim_end', [90.0])
+            voltage_base = list()
+            nt.assert_equal(
+                1, efel.cppcore.getFeature('voltage_base', voltage_base))
+            nt.assert_almost_equal(expected, voltage_base[0])
+
+    def test_setTraceFile(self):  # pylint: disable=R0201
+        """cppcore: Testing traces read from a trace file"""
+        import efel
+        import efel.io
+
+        data = np.loadtxt(
+            os.path.join(testdata_dir, 'basic/mean_frequency_1.txt'))
+        feature_names = ['peak_time', 'AP_amplitude', 'min_AHP_values',
+                         'voltage_base', 'time_constant']
+
+        def get_features():
+            # setTraceFile starts a new trace
+            efel.cppcore.setFeatureDouble('stim_start', [500.0])
+            efel.cppcore.setFeatureDouble('stim_end', [900.0])
+            efel.cppcore.setFeatureDouble('Threshold', [-20.0])
+            efel.cppcore.setFeatureDouble('DerivativeThreshold', [10.0])
+            efel.cppcore.setFeatureInt('DerivativeWindow', [3])
+            efel.cppcore.setFeatureDouble('interp_step', [0.1])
+            values = {}
+            for feature_name in feature_names:
+                feature_values = list()
+                efel.cppcore.getFeature(feature_name, feature_values)
+                values[feature_name] = feature_values
+            return values
+
+        self.setup_data()
+        expected = get_features()
+
+        tempdir = tempfile.mkdtemp('efel_tests')
+        try:
+            file_name = os.path.join(tempdir, 'trace.bin')
+            for layout in ['t_then_v', 'interleaved']:
+                efel.io.write_trace_file(file_name, data[:, 0], data[:, 1],
+                                         layout=layout)
+                nt.assert_equal(1, efel.cppcore.setTraceFile(file_name))
+                nt.assert_equal(expected, get_features())
+
+            # on the interpolation grid
+            efel.io.write_trace_file(file_name, voltage=data[:, 1],
+                                     layout='v_only', t0=0.0, dt=0.1)
+            nt.assert_equal(1, efel.cppcore.setTraceFile(file_name))
+            nt.assert_equal(len(data),
+                            len(efel.cppcore.getMapDoubleData('V')))
+            nt.assert_almost_equal(
+                0.1 * (len(data) - 1),
+                efel.cppcore.getMapDoubleData('T')[-1])
+
+            # Initialize drops the file, a trace has to be set again
+            efel.cppcore.setTraceFile(file_name)
+            efel.cppcore.Initialize(efel.getDependencyFileLocation(), "log")
+            efel.cppcore.setFeatureDouble('interp_step', [0.1])
+            efel.cppcore.setFeatureDouble('stim_start', [0.0])
+            efel.cppcore.setFeatureDouble('stim_end', [9.0])
+            nt.assert_equal(
+                -1, efel.cppcore.getFeature('maximum_voltage', list()))
+            efel.cppcore.getgError()
+
+            efel.cppcore.Initialize(efel.getDependencyFileLocation(), "log")
+            time = [0.1 * i for i in range(100)]
+            voltage = [-70.0 + 0.01 * i for i in range(100)]
+            efel.cppcore.setFeatureDouble('T', time)
+            efel.cppcore.setFeatureDouble('V', voltage)
+            efel.cppcore.setFeatureDouble('interp_step', [0.1])
+            efel.cppcore.setFeatureDouble('stim_start', [0.0])
+            efel.cppcore.setFeatureDouble('stim_end', [9.0])
+            maximum_voltage = list()
+            nt.assert_equal(
+                1, efel.cppcore.getFeature('maximum_voltage',
+                                           maximum_voltage))
+            nt.assert_almost_equal(voltage[90], maximum_voltage[0])
+            nt.assert_equal(voltage, efel.cppcore.getMapDoubleData('V'))
+
+            with open(file_name, 'wb') as trace_file:
+                trace_file.write(b'not a trace file' * 4)
+            nt.assert_equal(-1, efel.cppcore.setTraceFile(file_name))
+            nt.ok_('not a trace file' in efel.cppcore.getgError())
+        finally:
+            shutil.rmtree(tempdir)
+
     @nt.raises(TypeError)
     def test_getFeature_non_existant(self):  # pylint: disable=R0201
         """cppcore: Testing failure exit code in getFeature"""
@@ -175,6 +569,8 @@ class TestCppcore(object):
         try:
             efel.cppcore.Initialize(efel.getDependencyFileLocation(), tempdir)
             self.setup_data()
+            # the log is written by a background thread
+            efel.cppcore.flushLog()
             with open(os.path.join(tempdir, 'fllog.txt')) as fd:
                 contents = fd.read()
                 nt.ok_('Initializing' in contents)
@@ -182,3 +578,27 @@ class TestCppcore(object):
                 nt.ok_('...' in contents)
         finally:
             shutil.rmtree(tempdir)
+
+    def test_setLogLevel(self):  # pylint: disable=R0201
+        """cppcore: Testing the level of the logged messages"""
+        import efel
+        tempdir = tempfile.mkdtemp('efel_tests')
+        try:
+            efel.cppcore.Initialize(efel.getDependencyFileLocation(), tempdir)
+            efel.cppcore.setLogLevel(1)
+            self.setup_data()
+            efel.cppcore.getFeature('AP_amplitude', list())
+            efel.cppcore.flushLog()
+            with open(os.path.join(tempdir, 'fllog.txt')) as fd:
+                contents = fd.read()
+                nt.ok_('Initializing' in contents)
+                nt.ok_('Calculated feature' not in contents)
+
+            efel.cppcore.setLogLevel(0)
+            efel.cppcore.getFeature('AP_amplitude', list())
+            efel.cppcore.flushLog()
+            with open(os.path.join(tempdir, 'fllog.txt')) as fd:
+                nt.ok_('Calculated feature' in fd.read())
+        finally:
+            efel.cppcore.setLogLevel(0)
+            shutil.rmtree(tempdir)
@@ -43,7 +43,12 @@ cppcore_sources = ['cppcore.cpp',
                    'DependencyTree.cpp',
                    'efel.cpp',
                    'cfeature.cpp',
-                   'mapoperations.cpp']
+                   'mapoperations.cpp',
+                   'FeatureBatch.cpp',
+                   'FeatureStream.cpp',
+                   'TraceFile.cpp',
+                   'TraceGenerator.cpp',
+                   'eFELLogger.cpp']
 cppcore_headers = ['Utils.h',
                    'LibV1.h',
                    'LibV2.h',
@@ -57,7 +62,11 @@ cppcore_headers = ['Utils.h',
                    'Global.h',
                    'mapoperations.h',
                    'types.h',
-                   'eFELLogger.h']
+                   'eFELLogger.h',
+                   'FeatureBatch.h',
+                   'FeatureStream.h',
+                   'TraceFile.h',
+                   'TraceGenerator.h']
 cppcore_sources = [
     os.path.join(
         cppcore_dir,
@@ -69,7 +78,9 @@ cppcore_headers = [
 
 cppcore = Extension('efel.cppcore',
                     sources=cppcore_sources,
-                    include_dirs=['efel/cppcore/'])
+                    include_dirs=['efel/cppcore/'],
+                    extra_compile_args=['-std=c++11', '-pthread'],
+                    extra_link_args=['-pthread'])
 setup(
     name="efel",
     version=versioneer.get_version(),